@@ -36,8 +36,10 @@
 #include "models/filtermodel.h"
 #include "models/documentlistmodel.h"
 #include "models/trackerdocumentprovider.h"
+#include "models/filesystemdocumentprovider.h"
 #include "models/documentprovider.h"
 #include "models/documentproviderlistmodel.h"
+#include "models/thumbnailprovider.h"
 #include "dbusadaptor.h"
 
 namespace {
@@ -66,11 +68,13 @@ QSharedPointer<QQuickView> createView(const QString &file)
     qmlRegisterType<DocumentListModel>("Sailfish.Office.Files", 1, 0, "DocumentListModel");
     qmlRegisterType<DocumentProviderListModel>("Sailfish.Office.Files", 1, 0, "DocumentProviderListModel");
     qmlRegisterType<TrackerDocumentProvider>("Sailfish.Office.Files", 1, 0, "TrackerDocumentProvider");
+    qmlRegisterType<FilesystemDocumentProvider>("Sailfish.Office.Files", 1, 0, "FilesystemDocumentProvider");
     qmlRegisterType<FilterModel>("Sailfish.Office.Files", 1, 0, "FilterModel");
     qmlRegisterInterface<DocumentProvider>("DocumentProvider");
 
     QSharedPointer<QQuickView> view(MDeclarativeCache::qQuickView());
     view->engine()->addImportPath(CALLIGRA_QML_PLUGIN_DIR);
+    view->engine()->addImageProvider(QStringLiteral("thumbnail"), new ThumbnailProvider);
     view->setSource(QUrl::fromLocalFile(QML_INSTALL_DIR + file));
 
     new DBusAdaptor(view.data());
@@ -83,6 +87,34 @@ QSharedPointer<QQuickView> createView(const QString &file)
 
     return view;
 }
+
+// Compiles the document pages while prestarted, loading the plugins they import
+// and initializing Poppler, so that the first document opens as fast as the next ones.
+void warmUp(QQuickView *view)
+{
+    QQmlEngine *engine = view->engine();
+
+    QQmlComponent *component = new QQmlComponent(engine, view);
+    component->setData("import QtQuick 2.0\n"
+                       "import Sailfish.Office 1.0\n"
+                       "QtObject {\n"
+                       "    property Component pdf: Component { PDFDocumentPage {} }\n"
+                       "    property Component text: Component { TextDocumentPage {} }\n"
+                       "    property Component spreadsheet: Component { SpreadsheetPage {} }\n"
+                       "    property Component presentation: Component { PresentationPage {} }\n"
+                       "    property Component plainText: Component { PlainTextDocumentPage {} }\n"
+                       "}\n", QUrl::fromLocalFile(QML_INSTALL_DIR + QStringLiteral("WarmUp.qml")));
+
+    // Only the components are created, they keep the compiled pages around.
+    QObject *pages = component->create();
+    if (pages) {
+        pages->setParent(view);
+    } else {
+        qWarning() << "Could not compile the document pages:" << component->errors();
+    }
+
+    static_cast<ThumbnailProvider *>(engine->imageProvider(QStringLiteral("thumbnail")))->warmUp();
+}
 }
 
 
@@ -133,6 +165,8 @@ Q_DECL_EXPORT int main(int argc, char *argv[])
             QMetaObject::invokeMethod(view->rootObject(), "openFile", Q_ARG(QVariant, fileNameParameter));
         } else if (!preStart) {
             view->showFullScreen();
+        } else {
+            warmUp(view.data());
         }
 
         retn = app->exec();
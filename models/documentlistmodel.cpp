@@ -18,20 +18,142 @@
 
 #include "documentlistmodel.h"
 
+#include <QDataStream>
 #include <QDir>
+#include <QSet>
 
-struct DocumentListModelEntry
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace {
+
+struct MimeTypeClass
 {
-    QString fileName;
-    QString filePath;
-    QString fileType;
-    int fileSize;
-    QDateTime fileRead;
-    QString mimeType;
+    const char *mimeType;
     DocumentListModel::DocumentClass documentClass;
-    bool dirty; // When true, should be removed from list.
 };
 
+// Sorted by mime type, for a binary search.
+constexpr MimeTypeClass mimeTypeClasses[] = {
+    { "application/msword", DocumentListModel::TextDocument },
+    { "application/pdf", DocumentListModel::PDFDocument },
+    { "application/rtf", DocumentListModel::TextDocument },
+    { "application/vnd.ms-excel", DocumentListModel::SpreadSheetDocument },
+    { "application/vnd.ms-excel.sheet.macroEnabled", DocumentListModel::SpreadSheetDocument },
+    { "application/vnd.ms-excel.sheet.macroEnabled.12", DocumentListModel::SpreadSheetDocument },
+    { "application/vnd.ms-excel.template.macroEnabled.12", DocumentListModel::SpreadSheetDocument },
+    { "application/vnd.ms-powerpoint", DocumentListModel::PresentationDocument },
+    { "application/vnd.ms-powerpoint.presentation.macroEnabled.12", DocumentListModel::PresentationDocument },
+    { "application/vnd.ms-powerpoint.slideshow.macroEnabled.12", DocumentListModel::PresentationDocument },
+    { "application/vnd.ms-powerpoint.template.macroEnabled.12", DocumentListModel::PresentationDocument },
+    { "application/vnd.ms-word.document.macroEnabled.12", DocumentListModel::TextDocument },
+    { "application/vnd.ms-word.template.macroEnabled.12", DocumentListModel::TextDocument },
+    { "application/vnd.oasis.opendocument.presentation", DocumentListModel::PresentationDocument },
+    { "application/vnd.oasis.opendocument.spreadsheet", DocumentListModel::SpreadSheetDocument },
+    { "application/vnd.oasis.opendocument.text", DocumentListModel::TextDocument },
+    { "application/vnd.openxmlformats-officedocument.presentationml.presentation", DocumentListModel::PresentationDocument },
+    { "application/vnd.openxmlformats-officedocument.presentationml.slideshow", DocumentListModel::PresentationDocument },
+    { "application/vnd.openxmlformats-officedocument.presentationml.template", DocumentListModel::PresentationDocument },
+    { "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet", DocumentListModel::SpreadSheetDocument },
+    { "application/vnd.openxmlformats-officedocument.spreadsheetml.template", DocumentListModel::SpreadSheetDocument },
+    { "application/vnd.openxmlformats-officedocument.wordprocessingml.document", DocumentListModel::TextDocument },
+    { "application/vnd.openxmlformats-officedocument.wordprocessingml.template", DocumentListModel::TextDocument },
+    { "text/plain", DocumentListModel::PlainTextDocument }
+};
+
+constexpr int mimeTypeClassCount = sizeof(mimeTypeClasses) / sizeof(mimeTypeClasses[0]);
+
+constexpr bool lessThan(const char *left, const char *right)
+{
+    return *left != *right ? static_cast<unsigned char>(*left) < static_cast<unsigned char>(*right)
+                           : *left != 0 && lessThan(left + 1, right + 1);
+}
+
+constexpr bool isSorted(int index)
+{
+    return index + 1 >= mimeTypeClassCount
+            || (lessThan(mimeTypeClasses[index].mimeType, mimeTypeClasses[index + 1].mimeType)
+                && isSorted(index + 1));
+}
+
+static_assert(isSorted(0), "mimeTypeClasses must be sorted by mime type");
+
+// Most recently read first, by path for the same time so the order doesn't
+// depend on the order the entries were found in.
+bool entryLessThan(const DocumentListModelEntry &left, const DocumentListModelEntry &right)
+{
+    return left.readTime > right.readTime
+            || (left.readTime == right.readTime && left.filePath < right.filePath);
+}
+
+bool entryEquals(const DocumentListModelEntry &left, const DocumentListModelEntry &right)
+{
+    return left.fileName == right.fileName
+            && left.fileType == right.fileType
+            && left.fileSize == right.fileSize
+            && left.readTime == right.readTime
+            && left.mimeType == right.mimeType;
+}
+
+// Flags the longest increasing subsequence of values.
+QVector<bool> longestIncreasingSubsequence(const QVector<int> &values)
+{
+    QVector<int> tails;         // Index of the last value of the best subsequence of each length.
+    QVector<int> previous(values.count(), -1);
+
+    for (int i = 0; i < values.count(); ++i) {
+        const auto tail = std::lower_bound(tails.begin(), tails.end(), values.at(i), [&values](int index, int value) {
+            return values.at(index) < value;
+        });
+        if (tail != tails.begin()) {
+            previous[i] = *(tail - 1);
+        }
+        if (tail == tails.end()) {
+            tails.append(i);
+        } else {
+            *tail = i;
+        }
+    }
+
+    QVector<bool> flags(values.count(), false);
+    for (int i = tails.isEmpty() ? -1 : tails.last(); i >= 0; i = previous.at(i)) {
+        flags[i] = true;
+    }
+    return flags;
+}
+
+// Counts the rows present before a key in logarithmic time, with a Fenwick tree.
+class RowCounter
+{
+public:
+    explicit RowCounter(int keyCount)
+        : m_tree(keyCount + 1, 0)
+    {
+    }
+
+    void add(int key, int delta)
+    {
+        for (int i = key + 1; i < m_tree.count(); i += i & -i) {
+            m_tree[i] += delta;
+        }
+    }
+
+    int countBefore(int key) const
+    {
+        int count = 0;
+        for (int i = key; i > 0; i -= i & -i) {
+            count += m_tree.at(i);
+        }
+        return count;
+    }
+
+private:
+    QVector<int> m_tree;
+};
+
+}
+
 class DocumentListModel::Private
 {
 public:
@@ -42,10 +164,58 @@ public:
         roles.insert(FileTypeRole, "fileType");
         roles.insert(FileSizeRole, "fileSize");
         roles.insert(FileReadRole, "fileRead");
+        roles.insert(FileReadTimeRole, "fileReadTime");
         roles.insert(FileMimeTypeRole, "fileMimeType");
         roles.insert(FileDocumentClass, "fileDocumentClass");
     }
-    QList<DocumentListModelEntry> entries;
+    // Returns the shared copy of a string, for strings found in many entries.
+    QString intern(const QString &string)
+    {
+        return *strings.insert(string);
+    }
+
+    // While entries are inserted, the rows before gapStart are separated from the
+    // following ones by gapSize entries not shown yet.
+    int count() const
+    {
+        return entries.count() - gapSize;
+    }
+
+    const DocumentListModelEntry &at(int row) const
+    {
+        return entries.at(row < gapStart ? row : row + gapSize);
+    }
+
+    // The row of an entry is found from its read time, the entries being sorted.
+    int rowOf(const QString &path) const
+    {
+        const auto readTime = readTimes.constFind(path);
+        if (readTime == readTimes.constEnd()) {
+            return -1;
+        }
+
+        DocumentListModelEntry key;
+        key.filePath = path;
+        key.readTime = *readTime;
+        int first = 0;
+        for (int length = count(); length > 0;) {
+            const int half = length / 2;
+            if (entryLessThan(at(first + half), key)) {
+                first += half + 1;
+                length -= half + 1;
+            } else {
+                length = half;
+            }
+        }
+        return first < count() && at(first).filePath == path ? first : -1;
+    }
+
+    QVector<DocumentListModelEntry> entries;
+    int gapStart = 0;
+    int gapSize = 0;
+    QHash<QString, qint64> readTimes;   // The read time of each path, rather than its row which changes.
+    QSet<QString> strings;
+    QHash<QString, DocumentClass> documentClasses;  // The class of each mime type met.
     QHash<int, QByteArray> roles;
 };
 
@@ -60,24 +230,28 @@ DocumentListModel::~DocumentListModel()
 
 QVariant DocumentListModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid() || index.row() < 0 || index.row() >= d->entries.count())
+    if (!index.isValid() || index.row() < 0 || index.row() >= d->count())
         return QVariant();
-    
+
+    const DocumentListModelEntry &entry = d->at(index.row());
     switch (role) {
     case FileNameRole:
-        return d->entries.at(index.row()).fileName;
+        return entry.fileName;
     case FilePathRole:
-        return d->entries.at(index.row()).filePath;
+        return entry.filePath;
     case FileTypeRole:
-        return QString().append(d->entries.at(index.row()).fileType).append(d->entries.at(index.row()).fileRead.toString(Qt::ISODate));
+        return QString().append(entry.fileType)
+                .append(QDateTime::fromMSecsSinceEpoch(entry.readTime).toString(Qt::ISODate));
     case FileSizeRole:
-        return d->entries.at(index.row()).fileSize;
+        return entry.fileSize;
     case FileReadRole:
-        return d->entries.at(index.row()).fileRead;
+        return QDateTime::fromMSecsSinceEpoch(entry.readTime);
+    case FileReadTimeRole:
+        return entry.readTime;
     case FileMimeTypeRole:
-        return d->entries.at(index.row()).mimeType;
+        return entry.mimeType;
     case FileDocumentClass:
-        return d->entries.at(index.row()).documentClass;
+        return entry.documentClass;
     default:
         break;
     }
@@ -89,7 +263,7 @@ int DocumentListModel::rowCount(const QModelIndex& parent) const
 {
     if (parent.isValid())
         return 0;
-    return d->entries.count();
+    return d->count();
 }
 
 QHash<int, QByteArray> DocumentListModel::roleNames() const
@@ -99,67 +273,158 @@ QHash<int, QByteArray> DocumentListModel::roleNames() const
 
 void DocumentListModel::setAllItemsDirty(bool status)
 {
-    for (QList<DocumentListModelEntry>::iterator entry = d->entries.begin(); entry != d->entries.end(); entry++) {
+    for (QVector<DocumentListModelEntry>::iterator entry = d->entries.begin(); entry != d->entries.end(); entry++) {
         entry->dirty = status;
     }
 }
 
 void DocumentListModel::addItem(QString name, QString path, QString type, int size, QDateTime lastRead, QString mimeType)
 {
-    // We sometimes get duplicate entries... and that's kind of silly.
-    for (QList<DocumentListModelEntry>::iterator entry = d->entries.begin();
-        entry != d->entries.end(); entry++) {
-        if (entry->filePath == path) {
-            entry->dirty = false;
-            entry->fileType = type;
-            entry->fileSize = size;
-            entry->fileRead = lastRead;
-            entry->mimeType = mimeType;
-            entry->documentClass = static_cast<DocumentClass>(mimeTypeToDocumentClass(mimeType));
-            return;
-        }
-    }
-
     DocumentListModelEntry entry;
-    entry.dirty    = false;
     entry.fileName = name;
     entry.filePath = path;
     entry.fileType = type;
     entry.fileSize = size;
-    entry.fileRead = lastRead;
+    entry.readTime = lastRead.toMSecsSinceEpoch();
     entry.mimeType = mimeType;
-    entry.documentClass = static_cast<DocumentClass>(mimeTypeToDocumentClass(mimeType));
+    prepareEntry(&entry);
 
-    int index = 0;
-    for (; index < d->entries.count(); ++index) {
-        if (d->entries.at(index).fileRead < entry.fileRead)
-            break;
+    // We sometimes get duplicate entries... and that's kind of silly.
+    const int row = d->rowOf(path);
+    if (row >= 0) {
+        setItem(row, entry);
+        return;
     }
 
+    const int index = std::upper_bound(d->entries.begin(), d->entries.end(), entry, entryLessThan)
+            - d->entries.begin();
+
     beginInsertRows(QModelIndex(), index, index);
     d->entries.insert(index, entry);
+    d->readTimes.insert(path, entry.readTime);
     endInsertRows();
 }
 
+void DocumentListModel::addItems(QVector<DocumentListModelEntry> entries)
+{
+    QVector<DocumentListModelEntry> added;
+    QSet<QString> addedPaths;
+    for (DocumentListModelEntry &entry : entries) {
+        prepareEntry(&entry);
+
+        const int row = d->rowOf(entry.filePath);
+        if (row >= 0) {
+            setItem(row, entry);
+        } else if (!addedPaths.contains(entry.filePath)) {
+            addedPaths.insert(entry.filePath);
+            added.append(entry);
+        }
+    }
+    if (added.isEmpty()) {
+        return;
+    }
+
+    std::sort(added.begin(), added.end(), entryLessThan);
+    QVector<int> positions;
+    positions.reserve(added.count());
+    for (const DocumentListModelEntry &entry : added) {
+        positions.append(std::upper_bound(d->entries.begin(), d->entries.end(), entry, entryLessThan)
+                         - d->entries.begin());
+    }
+
+    // Entries going to the same position are inserted together, from the end so the
+    // positions before stay valid. The list is merged in a single pass: room is made
+    // at the end, and each old entry is moved once, straight to its final place. Until
+    // the first group is inserted, the gap left between the entries before the current
+    // group and the ones already moved is skipped by data().
+    const int oldCount = d->entries.count();
+    d->entries.resize(oldCount + added.count());
+    d->gapStart = oldCount;
+    d->gapSize = added.count();
+
+    int end = oldCount;                 // The old entries before end are still in place.
+    int merged = d->entries.count();    // The entries from merged on are in place.
+    for (int last = added.count() - 1; last >= 0;) {
+        const int position = positions.at(last);
+        int first = last;
+        while (first > 0 && positions.at(first - 1) == position) {
+            --first;
+        }
+
+        beginInsertRows(QModelIndex(), position, position + last - first);
+        const QVector<DocumentListModelEntry>::iterator begin = d->entries.begin();
+        std::move_backward(begin + position, begin + end, begin + merged);
+        merged -= end - position + last - first + 1;
+        std::copy(added.begin() + first, added.begin() + last + 1, begin + merged);
+        end = position;
+        d->gapStart = position;
+        d->gapSize = merged - position;
+        endInsertRows();
+
+        last = first - 1;
+    }
+
+    for (const DocumentListModelEntry &entry : added) {
+        d->readTimes.insert(entry.filePath, entry.readTime);
+    }
+}
+
+void DocumentListModel::setItem(int row, const DocumentListModelEntry &entry)
+{
+    if (entryEquals(d->entries.at(row), entry)) {
+        d->entries[row].dirty = false;
+        return;
+    }
+
+    const bool moved = entry.readTime != d->entries.at(row).readTime;
+    d->entries[row] = entry;
+    d->readTimes.insert(entry.filePath, entry.readTime);
+    emit dataChanged(index(row), index(row));
+
+    if (moved) {
+        // The rest of the list is sorted, the entry goes up or down to where it would
+        // be inserted.
+        int destination = std::upper_bound(d->entries.begin(), d->entries.begin() + row, entry, entryLessThan)
+                - d->entries.begin();
+        if (destination == row) {
+            destination = std::upper_bound(d->entries.begin() + row + 1, d->entries.end(), entry, entryLessThan)
+                    - d->entries.begin();
+        }
+        if (destination < row || destination > row + 1) {
+            beginMoveRows(QModelIndex(), row, row, QModelIndex(), destination);
+            d->entries.move(row, destination > row ? destination - 1 : destination);
+            endMoveRows();
+        }
+    }
+}
+
 void DocumentListModel::removeItemsDirty()
 {
-    for (int index=0; index < d->entries.count();) {
-        if (d->entries.at(index).dirty) {
-            beginRemoveRows(QModelIndex(), index, index);
-            d->entries.removeAt(index);
+    // Contiguous dirty rows are removed together, from the end so the rows before
+    // them don't change.
+    int first = -1;
+    for (int index = d->entries.count() - 1; index >= -1; --index) {
+        const bool dirty = index >= 0 && d->entries.at(index).dirty;
+        if (dirty && first < 0) {
+            first = index;
+        } else if (!dirty && first >= 0) {
+            beginRemoveRows(QModelIndex(), index + 1, first);
+            for (int row = index + 1; row <= first; ++row) {
+                d->readTimes.remove(d->entries.at(row).filePath);
+            }
+            d->entries.erase(d->entries.begin() + index + 1, d->entries.begin() + first + 1);
             endRemoveRows();
-        } else {
-            ++index;
+            first = -1;
         }
     }
 }
 
-
 void DocumentListModel::removeAt(int index)
 {
     if (index > -1 && index < d->entries.count()) {
         beginRemoveRows(QModelIndex(), index, index);
-        d->entries.removeAt(index);
+        d->readTimes.remove(d->entries.at(index).filePath);
+        d->entries.remove(index);
         endRemoveRows();
     }
 }
@@ -168,42 +433,228 @@ void DocumentListModel::clear()
 {
     beginResetModel();
     d->entries.clear();
+    d->readTimes.clear();
     endResetModel();
 }
 
+void DocumentListModel::applySnapshot(QVector<DocumentListModelEntry> entries)
+{
+    for (DocumentListModelEntry &entry : entries) {
+        prepareEntry(&entry);
+    }
+    std::sort(entries.begin(), entries.end(), entryLessThan);
+
+    // The most recently read entry is kept for duplicates.
+    QSet<QString> paths;
+    paths.reserve(entries.count());
+    int count = 0;
+    for (int i = 0; i < entries.count(); ++i) {
+        if (!paths.contains(entries.at(i).filePath)) {
+            paths.insert(entries.at(i).filePath);
+            if (count != i) {
+                entries[count] = entries.at(i);
+            }
+            ++count;
+        }
+    }
+    entries.resize(count);
+
+    for (DocumentListModelEntry &entry : d->entries) {
+        entry.dirty = !paths.contains(entry.filePath);
+    }
+    removeItemsDirty();
+
+    // Rows which are already in the right order relative to each other stay where they
+    // are, the other ones are moved in front of the first staying row which comes after
+    // them. Each moved row gets a key between those of the rows around its destination,
+    // so positions are counted from the keys in logarithmic time.
+    QHash<QString, int> originalRows;
+    originalRows.reserve(d->entries.count());
+    for (int row = 0; row < d->entries.count(); ++row) {
+        originalRows.insert(d->entries.at(row).filePath, row);
+    }
+    QVector<int> order;         // The original row of each kept entry, in the new order.
+    QVector<int> ranks(d->entries.count());
+    order.reserve(d->entries.count());
+    for (const DocumentListModelEntry &entry : entries) {
+        const auto original = originalRows.constFind(entry.filePath);
+        if (original != originalRows.constEnd()) {
+            ranks[*original] = order.count();
+            order.append(*original);
+        }
+    }
+    const QVector<bool> stable = longestIncreasingSubsequence(ranks);
+
+    // The staying row each moved row goes in front of, the end of the list for none.
+    const int rowCount = d->entries.count();
+    QVector<int> anchors(rowCount);
+    QVector<int> slotCounts(rowCount + 1, 0);
+    for (int rank = rowCount - 1, anchor = rowCount; rank >= 0; --rank) {
+        if (stable.at(order.at(rank))) {
+            anchor = order.at(rank);
+        } else {
+            anchors[order.at(rank)] = anchor;
+            ++slotCounts[anchor];
+        }
+    }
+    QVector<int> keys(rowCount);
+    QVector<int> nextSlots(rowCount + 1);
+    int keyCount = 0;
+    for (int row = 0; row <= rowCount; ++row) {
+        nextSlots[row] = keyCount;
+        keyCount += slotCounts.at(row);
+        if (row < rowCount) {
+            keys[row] = keyCount++;
+        }
+    }
+    RowCounter rows(keyCount);
+    for (int row = 0; row < rowCount; ++row) {
+        rows.add(keys.at(row), 1);
+    }
+
+    for (int rank = 0; rank < rowCount;) {
+        const int original = order.at(rank);
+        if (stable.at(original)) {
+            ++rank;
+            continue;
+        }
+
+        // Rows which were together and go together are moved at once.
+        int count = 1;
+        while (rank + count < rowCount && order.at(rank + count) == original + count
+               && !stable.at(original + count) && anchors.at(original + count) == anchors.at(original)) {
+            ++count;
+        }
+        const int source = rows.countBefore(keys.at(original));
+        for (int i = 0; i < count; ++i) {
+            rows.add(keys.at(original + i), -1);
+        }
+        const int slot = nextSlots[anchors.at(original)];
+        nextSlots[anchors.at(original)] += count;
+        const int destination = rows.countBefore(slot);
+        for (int i = 0; i < count; ++i) {
+            rows.add(slot + i, 1);
+        }
+
+        const QVector<DocumentListModelEntry>::iterator begin = d->entries.begin();
+        if (destination < source) {
+            beginMoveRows(QModelIndex(), source, source + count - 1, QModelIndex(), destination);
+            std::rotate(begin + destination, begin + source, begin + source + count);
+        } else {
+            beginMoveRows(QModelIndex(), source, source + count - 1, QModelIndex(), destination + count);
+            std::rotate(begin + source, begin + source + count, begin + destination + count);
+        }
+        endMoveRows();
+        rank += count;
+    }
+
+    // The kept rows are in order now, new entries are inserted and changed ones updated.
+    int changedFirst = -1;
+    for (int row = 0; row <= entries.count(); ++row) {
+        const bool found = row < entries.count() && row < d->entries.count()
+                && d->entries.at(row).filePath == entries.at(row).filePath;
+        const bool changed = found && !entryEquals(d->entries.at(row), entries.at(row));
+
+        if (changed) {
+            d->entries[row] = entries.at(row);
+            if (changedFirst < 0) {
+                changedFirst = row;
+            }
+        }
+        if (!changed && changedFirst >= 0) {
+            emit dataChanged(index(changedFirst), index(row - 1));
+            changedFirst = -1;
+        }
+        if (found || row == entries.count()) {
+            continue;
+        }
+
+        // Insert the following new entries together.
+        int last = row;
+        while (last + 1 < entries.count() && !originalRows.contains(entries.at(last + 1).filePath)) {
+            ++last;
+        }
+        beginInsertRows(QModelIndex(), row, last);
+        d->entries.insert(row, last - row + 1, DocumentListModelEntry());
+        std::copy(entries.begin() + row, entries.begin() + last + 1, d->entries.begin() + row);
+        endInsertRows();
+        row = last;
+    }
+
+    d->readTimes.clear();
+    d->readTimes.reserve(d->entries.count());
+    for (const DocumentListModelEntry &entry : d->entries) {
+        d->readTimes.insert(entry.filePath, entry.readTime);
+    }
+}
+
+QVector<DocumentListModelEntry> DocumentListModel::snapshot() const
+{
+    if (d->gapSize > 0) {
+        QVector<DocumentListModelEntry> entries;
+        entries.reserve(d->count());
+        std::copy(d->entries.constBegin(), d->entries.constBegin() + d->gapStart, std::back_inserter(entries));
+        std::copy(d->entries.constBegin() + d->gapStart + d->gapSize, d->entries.constEnd(),
+                  std::back_inserter(entries));
+        return entries;
+    }
+    return d->entries;
+}
+
+const DocumentListModelEntry &DocumentListModel::entryAt(int row) const
+{
+    return d->at(row);
+}
+
+int DocumentListModel::indexOf(const QString &path) const
+{
+    return d->rowOf(path);
+}
+
+void DocumentListModel::prepareEntry(DocumentListModelEntry *entry)
+{
+    entry->fileType = d->intern(entry->fileType);
+    entry->mimeType = d->intern(entry->mimeType);
+    entry->documentClass = static_cast<DocumentClass>(mimeTypeToDocumentClass(entry->mimeType));
+    entry->dirty = false;
+}
+
 int DocumentListModel::mimeTypeToDocumentClass(QString mimeType) const
 {
-    DocumentClass documentClass = UnknownDocument;
-    if (mimeType == QLatin1String("application/vnd.oasis.opendocument.text")
-            || mimeType == QLatin1String("application/msword")
-            || mimeType == QLatin1String("application/vnd.openxmlformats-officedocument.wordprocessingml.document")
-            || mimeType == QLatin1String("application/vnd.openxmlformats-officedocument.wordprocessingml.template")
-            || mimeType == QLatin1String("application/vnd.ms-word.document.macroEnabled.12")
-            || mimeType == QLatin1String("application/vnd.ms-word.template.macroEnabled.12")
-            || mimeType == QLatin1String("application/rtf")) {
-        documentClass = TextDocument;
-    } else if (mimeType == QLatin1String("text/plain")) {
-        documentClass = PlainTextDocument;
-    } else if (mimeType == QLatin1String("application/vnd.oasis.opendocument.presentation")
-               || mimeType == QLatin1String("application/vnd.ms-powerpoint")
-               || mimeType == QLatin1String("application/vnd.openxmlformats-officedocument.presentationml.presentation")
-               || mimeType == QLatin1String("application/vnd.openxmlformats-officedocument.presentationml.template")
-               || mimeType == QLatin1String("application/vnd.openxmlformats-officedocument.presentationml.slideshow")
-               || mimeType == QLatin1String("application/vnd.ms-powerpoint.presentation.macroEnabled.12")
-               || mimeType == QLatin1String("application/vnd.ms-powerpoint.template.macroEnabled.12")
-               || mimeType == QLatin1String("application/vnd.ms-powerpoint.slideshow.macroEnabled.12") ) {
-        documentClass = PresentationDocument;
-    } else if (mimeType == QLatin1String("application/vnd.oasis.opendocument.spreadsheet")
-               || mimeType == QLatin1String("application/vnd.ms-excel")
-               || mimeType == QLatin1String("application/vnd.openxmlformats-officedocument.spreadsheetml.sheet")
-               || mimeType == QLatin1String("application/vnd.openxmlformats-officedocument.spreadsheetml.template")
-               || mimeType == QLatin1String("application/vnd.ms-excel.sheet.macroEnabled")
-               || mimeType == QLatin1String("application/vnd.ms-excel.sheet.macroEnabled.12")
-               || mimeType == QLatin1String("application/vnd.ms-excel.template.macroEnabled.12") ) {
-        documentClass = SpreadSheetDocument;
-    } else if (mimeType == QLatin1String("application/pdf")) {
-        documentClass = PDFDocument;
+    // Documents share a handful of mime types, each one is only looked up once.
+    const auto cached = d->documentClasses.constFind(mimeType);
+    if (cached != d->documentClasses.constEnd()) {
+        return *cached;
     }
 
+    const QByteArray type = mimeType.toLatin1();
+    const auto end = std::end(mimeTypeClasses);
+    const auto match = std::lower_bound(
+                std::begin(mimeTypeClasses), end, type.constData(),
+                [](const MimeTypeClass &entry, const char *type) {
+        return std::strcmp(entry.mimeType, type) < 0;
+    });
+
+    const DocumentClass documentClass = match != end && std::strcmp(match->mimeType, type.constData()) == 0
+            ? match->documentClass
+            : UnknownDocument;
+    d->documentClasses.insert(mimeType, documentClass);
+
     return documentClass;
 }
+
+QDataStream &operator<<(QDataStream &stream, const DocumentListModelEntry &entry)
+{
+    return stream << entry.fileName << entry.filePath << entry.fileType << qint32(entry.fileSize)
+                  << entry.readTime << entry.mimeType;
+}
+
+QDataStream &operator>>(QDataStream &stream, DocumentListModelEntry &entry)
+{
+    qint32 fileSize = 0;
+    stream >> entry.fileName >> entry.filePath >> entry.fileType >> fileSize >> entry.readTime >> entry.mimeType;
+    entry.fileSize = fileSize;
+    entry.documentClass = DocumentListModel::UnknownDocument;
+    entry.dirty = false;
+    return stream;
+}
@@ -20,9 +20,12 @@
 #define DOCUMENTLISTMODEL_H
 
 #include <QAbstractListModel>
+#include <QVector>
 #include <qdatetime.h>
 
+class QDataStream;
 class DocumentListModelPrivate;
+struct DocumentListModelEntry;
 
 class DocumentListModel : public QAbstractListModel
 {
@@ -45,6 +48,7 @@ public:
         FileTypeRole,
         FileSizeRole,
         FileReadRole,
+        FileReadTimeRole,   // FileReadRole in ms since the epoch, without building a QDateTime.
         FileMimeTypeRole,
         FileDocumentClass
     };
@@ -65,11 +69,44 @@ public:
     void removeAt(int index);
     void clear();
 
+    // Replaces the content of the model with entries, only emitting the rows
+    // which were inserted, removed, moved or changed.
+    void applySnapshot(QVector<DocumentListModelEntry> entries);
+    // Adds or updates entries, inserting the new ones in as few ranges as possible.
+    void addItems(QVector<DocumentListModelEntry> entries);
+    QVector<DocumentListModelEntry> snapshot() const;
+    // The entry of a valid row, without going through data().
+    const DocumentListModelEntry &entryAt(int row) const;
+    int indexOf(const QString &path) const;
+
     Q_INVOKABLE int mimeTypeToDocumentClass(QString mimeType) const;
 
 private:
+    void prepareEntry(DocumentListModelEntry *entry);
+    void setItem(int row, const DocumentListModelEntry &entry);
+
     class Private;
     const QScopedPointer<Private> d;
 };
 
+// Entries are stored by value in the model, which shares the type and mime type
+// strings between them. The model fills the fields after fileSize.
+struct DocumentListModelEntry
+{
+    QString fileName;
+    QString filePath;
+    QString fileType;
+    QString mimeType;
+    qint64 readTime = 0;    // In ms since the epoch, the date is only built for display.
+    int fileSize = 0;
+    DocumentListModel::DocumentClass documentClass = DocumentListModel::UnknownDocument;
+    bool dirty = false; // When true, should be removed from list.
+};
+
+Q_DECLARE_TYPEINFO(DocumentListModelEntry, Q_MOVABLE_TYPE);
+Q_DECLARE_METATYPE(DocumentListModelEntry)
+
+QDataStream &operator<<(QDataStream &stream, const DocumentListModelEntry &entry);
+QDataStream &operator>>(QDataStream &stream, DocumentListModelEntry &entry);
+
 #endif // DOCUMENTLISTMODEL_H
@@ -0,0 +1,493 @@
+/*
+ * Copyright (C) 2026 Caliste Damien.
+ * Contact: Damien Caliste <dcaliste@free.fr>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 only.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "filesystemdocumentprovider.h"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QFileSystemWatcher>
+#include <QtCore/QHash>
+#include <QtCore/QRunnable>
+#include <QtCore/QSet>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QThreadPool>
+#include <QtCore/QTimer>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Changes are collected for that long before the directories are read again, in ms.
+const int changeDelay = 200;
+// Known directories are read again that often, in ms, to find documents edited in place.
+const int refreshInterval = 5 * 60 * 1000;
+
+struct ExtensionMimeType
+{
+    const char *extension;
+    const char *mimeType;
+};
+
+// Sorted by extension.
+const ExtensionMimeType extensionMimeTypes[] = {
+    { "doc", "application/msword" },
+    { "docm", "application/vnd.ms-word.document.macroEnabled.12" },
+    { "docx", "application/vnd.openxmlformats-officedocument.wordprocessingml.document" },
+    { "dotm", "application/vnd.ms-word.template.macroEnabled.12" },
+    { "dotx", "application/vnd.openxmlformats-officedocument.wordprocessingml.template" },
+    { "odp", "application/vnd.oasis.opendocument.presentation" },
+    { "ods", "application/vnd.oasis.opendocument.spreadsheet" },
+    { "odt", "application/vnd.oasis.opendocument.text" },
+    { "pdf", "application/pdf" },
+    { "potm", "application/vnd.ms-powerpoint.template.macroEnabled.12" },
+    { "potx", "application/vnd.openxmlformats-officedocument.presentationml.template" },
+    { "ppsm", "application/vnd.ms-powerpoint.slideshow.macroEnabled.12" },
+    { "ppsx", "application/vnd.openxmlformats-officedocument.presentationml.slideshow" },
+    { "ppt", "application/vnd.ms-powerpoint" },
+    { "pptm", "application/vnd.ms-powerpoint.presentation.macroEnabled.12" },
+    { "pptx", "application/vnd.openxmlformats-officedocument.presentationml.presentation" },
+    { "rtf", "application/rtf" },
+    { "txt", "text/plain" },
+    { "xls", "application/vnd.ms-excel" },
+    { "xlsm", "application/vnd.ms-excel.sheet.macroEnabled.12" },
+    { "xlsx", "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet" },
+    { "xltm", "application/vnd.ms-excel.template.macroEnabled.12" },
+    { "xltx", "application/vnd.openxmlformats-officedocument.spreadsheetml.template" }
+};
+
+// The mime type of a document in the directory dirFd, or null for other files. Files
+// without an extension are recognized by their first bytes.
+const char *documentMimeType(int dirFd, const char *name)
+{
+    const char * const dot = std::strrchr(name, '.');
+    if (dot) {
+        char extension[8];
+        const size_t length = std::strlen(dot + 1);
+        if (length == 0 || length >= sizeof(extension)) {
+            return nullptr;
+        }
+        for (size_t i = 0; i <= length; ++i) {
+            const char c = dot[1 + i];
+            extension[i] = c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+        }
+
+        const auto end = std::end(extensionMimeTypes);
+        const auto type = std::lower_bound(
+                    std::begin(extensionMimeTypes), end, extension,
+                    [](const ExtensionMimeType &type, const char *extension) {
+            return std::strcmp(type.extension, extension) < 0;
+        });
+        return type != end && std::strcmp(type->extension, extension) == 0 ? type->mimeType : nullptr;
+    }
+
+    const int fd = openat(dirFd, name, O_RDONLY | O_CLOEXEC | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) {
+        return nullptr;
+    }
+    char magic[5];
+    const bool read = ::read(fd, magic, sizeof(magic)) == sizeof(magic);
+    ::close(fd);
+
+    if (read && std::memcmp(magic, "%PDF-", 5) == 0) {
+        return "application/pdf";
+    } else if (read && std::memcmp(magic, "{\\rtf", 5) == 0) {
+        return "application/rtf";
+    }
+    return nullptr;
+}
+
+// Reads a single directory on a thread of the pool and hands its documents and its
+// subdirectories to the provider.
+class DirectoryReader : public QRunnable
+{
+public:
+    DirectoryReader(QObject *receiver, const QAtomicInt *generation, const QString &path)
+        : m_receiver(receiver)
+        , m_generation(generation)
+        , m_id(generation->load())
+        , m_path(path)
+    {
+    }
+
+    void run() override
+    {
+        if (m_generation->load() != m_id) {
+            return;
+        }
+
+        QVector<DocumentListModelEntry> entries;
+        QStringList subdirectories;
+
+        // readdir() reads the entries in large chunks with getdents(), and gives their type
+        // for most file systems, so only documents need to be stat()ed.
+        DIR * const dir = opendir(QFile::encodeName(m_path).constData());
+        if (dir) {
+            const int dirFd = dirfd(dir);
+            while (const struct dirent *entry = readdir(dir)) {
+                if (entry->d_name[0] == '.') {
+                    // Hidden files and directories, and . and ..
+                    continue;
+                }
+
+                unsigned char type = entry->d_type;
+                struct stat status;
+                if (type == DT_UNKNOWN) {
+                    if (fstatat(dirFd, entry->d_name, &status, AT_SYMLINK_NOFOLLOW) != 0) {
+                        continue;
+                    }
+                    type = S_ISDIR(status.st_mode) ? DT_DIR : S_ISLNK(status.st_mode) ? DT_LNK : DT_REG;
+                }
+
+                const QString name = QFile::decodeName(entry->d_name);
+                if (type == DT_DIR) {
+                    // Links to directories aren't followed, to avoid cycles.
+                    subdirectories.append(m_path + QLatin1Char('/') + name);
+                    continue;
+                } else if (type != DT_REG && type != DT_LNK) {
+                    continue;
+                }
+
+                const char * const mimeType = documentMimeType(dirFd, entry->d_name);
+                if (!mimeType || fstatat(dirFd, entry->d_name, &status, 0) != 0 || !S_ISREG(status.st_mode)) {
+                    continue;
+                }
+
+                DocumentListModelEntry document;
+                document.fileName = name;
+                document.filePath = QUrl::fromLocalFile(m_path + QLatin1Char('/') + name).toString(QUrl::FullyEncoded);
+                document.fileType = document.filePath.split('.').last();
+                document.fileSize = int(qMin<qint64>(status.st_size, INT_MAX));
+                document.readTime = qint64(status.st_atim.tv_sec) * 1000 + status.st_atim.tv_nsec / 1000000;
+                document.mimeType = QLatin1String(mimeType);
+                entries.append(document);
+            }
+            closedir(dir);
+        }
+
+        QMetaObject::invokeMethod(m_receiver, "addDirectory", Qt::QueuedConnection,
+                                  Q_ARG(int, m_id),
+                                  Q_ARG(QString, m_path),
+                                  Q_ARG(QVector<DocumentListModelEntry>, entries),
+                                  Q_ARG(QStringList, subdirectories),
+                                  Q_ARG(bool, dir != nullptr));
+    }
+
+private:
+    QObject * const m_receiver;
+    const QAtomicInt * const m_generation;
+    const int m_id;
+    const QString m_path;
+};
+
+}
+
+class FilesystemDocumentProvider::Private {
+public:
+    Private()
+        : model(new DocumentListModel)
+        , complete(false)
+        , ready(false)
+    {
+        model->setObjectName("FilesystemDocumentList");
+
+        directories.append(QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation));
+        directories.append(QStandardPaths::writableLocation(QStandardPaths::DownloadLocation));
+
+        changeTimer.setSingleShot(true);
+        changeTimer.setInterval(changeDelay);
+        refreshTimer.setInterval(refreshInterval);
+    }
+
+    ~Private() {
+        model->deleteLater();
+    }
+
+    DocumentListModel *model;
+    QStringList directories;
+    bool complete;
+    bool ready;
+    QHash<QString, QSet<QString> > files;           // The documents of each directory read.
+    QHash<QString, QStringList> subdirectories;     // The subdirectories of each directory read.
+    QSet<QString> readingDirectories;
+    QSet<QString> changedDirectories;
+    QFileSystemWatcher watcher;
+    QTimer changeTimer;
+    QTimer refreshTimer;
+    QThreadPool pool;
+    QAtomicInt generation;
+};
+
+FilesystemDocumentProvider::FilesystemDocumentProvider(QObject *parent)
+    : DocumentProvider(parent)
+    , d(new Private)
+{
+    qRegisterMetaType<QVector<DocumentListModelEntry> >();
+
+    connect(&d->watcher, &QFileSystemWatcher::directoryChanged,
+            this, &FilesystemDocumentProvider::directoryChanged);
+    connect(&d->changeTimer, &QTimer::timeout, this, &FilesystemDocumentProvider::readChangedDirectories);
+    connect(&d->refreshTimer, &QTimer::timeout, this, &FilesystemDocumentProvider::refresh);
+}
+
+FilesystemDocumentProvider::~FilesystemDocumentProvider()
+{
+    d->generation.ref();
+    d->pool.waitForDone();
+
+    delete d;
+}
+
+void FilesystemDocumentProvider::classBegin()
+{
+}
+
+void FilesystemDocumentProvider::componentComplete()
+{
+    d->complete = true;
+    start();
+}
+
+QStringList FilesystemDocumentProvider::directories() const
+{
+    return d->directories;
+}
+
+void FilesystemDocumentProvider::setDirectories(const QStringList &directories)
+{
+    if (d->directories != directories) {
+        d->directories = directories;
+        emit directoriesChanged();
+
+        if (d->complete) {
+            start();
+        }
+    }
+}
+
+void FilesystemDocumentProvider::start()
+{
+    // Results of the directories being read are ignored from now on.
+    d->generation.ref();
+
+    if (!d->watcher.directories().isEmpty()) {
+        d->watcher.removePaths(d->watcher.directories());
+    }
+    d->files.clear();
+    d->subdirectories.clear();
+    d->readingDirectories.clear();
+    d->changedDirectories.clear();
+    d->model->clear();
+
+    for (const QString &directory : d->directories) {
+        if (!directory.isEmpty()) {
+            readDirectory(QDir::cleanPath(directory));
+        }
+    }
+
+    d->refreshTimer.start();
+
+    const bool ready = d->readingDirectories.isEmpty();
+    if (d->ready != ready) {
+        d->ready = ready;
+        emit readyChanged();
+    }
+    emit countChanged();
+}
+
+void FilesystemDocumentProvider::readDirectory(const QString &path)
+{
+    d->readingDirectories.insert(path);
+    d->pool.start(new DirectoryReader(this, &d->generation, path));
+}
+
+void FilesystemDocumentProvider::removeDirectory(const QString &path)
+{
+    const QString prefix = path + QLatin1Char('/');
+    for (auto directory = d->files.begin(); directory != d->files.end();) {
+        if (directory.key() == path || directory.key().startsWith(prefix)) {
+            for (const QString &file : directory.value()) {
+                d->model->removeAt(d->model->indexOf(file));
+            }
+            d->subdirectories.remove(directory.key());
+            d->watcher.removePath(directory.key());
+            directory = d->files.erase(directory);
+        } else {
+            ++directory;
+        }
+    }
+
+    // The results of the subdirectories still being read are ignored.
+    for (QSet<QString> *directories : { &d->readingDirectories, &d->changedDirectories }) {
+        for (auto directory = directories->begin(); directory != directories->end();) {
+            if (*directory == path || directory->startsWith(prefix)) {
+                directory = directories->erase(directory);
+            } else {
+                ++directory;
+            }
+        }
+    }
+}
+
+void FilesystemDocumentProvider::addDirectory(
+        int generation, const QString &path, const QVector<DocumentListModelEntry> &entries,
+        const QStringList &subdirectories, bool exists)
+{
+    if (generation != d->generation.load() || !d->readingDirectories.remove(path)) {
+        // A directory removed while it was read isn't tracked any more.
+        return;
+    }
+
+    if (!exists) {
+        removeDirectory(path);
+    } else {
+        if (!d->files.contains(path)) {
+            d->watcher.addPath(path);
+        }
+
+        // Compare with what the directory contained before.
+        QSet<QString> &files = d->files[path];
+        QSet<QString> found;
+        for (const DocumentListModelEntry &entry : entries) {
+            found.insert(entry.filePath);
+        }
+        for (const QString &file : files) {
+            if (!found.contains(file)) {
+                d->model->removeAt(d->model->indexOf(file));
+            }
+        }
+        files = found;
+        // Known documents are updated too, with their size and date read again.
+        d->model->addItems(entries);
+
+        const QStringList previousSubdirectories = d->subdirectories.value(path);
+        for (const QString &subdirectory : previousSubdirectories) {
+            if (!subdirectories.contains(subdirectory)) {
+                removeDirectory(subdirectory);
+            }
+        }
+        d->subdirectories.insert(path, subdirectories);
+        for (const QString &subdirectory : subdirectories) {
+            if (!d->files.contains(subdirectory) && !d->readingDirectories.contains(subdirectory)) {
+                readDirectory(subdirectory);
+            }
+        }
+    }
+
+    if (!d->ready && d->readingDirectories.isEmpty()) {
+        d->ready = true;
+        emit readyChanged();
+    }
+    emit countChanged();
+}
+
+void FilesystemDocumentProvider::directoryChanged(const QString &path)
+{
+    d->changedDirectories.insert(path);
+    if (!d->changeTimer.isActive()) {
+        d->changeTimer.start();
+    }
+}
+
+void FilesystemDocumentProvider::refresh()
+{
+    // Editing a document in place doesn't change its directory, and watching each
+    // document would use up the inotify watches shared with the whole session.
+    for (auto directory = d->files.constBegin(); directory != d->files.constEnd(); ++directory) {
+        d->changedDirectories.insert(directory.key());
+    }
+    readChangedDirectories();
+}
+
+void FilesystemDocumentProvider::readChangedDirectories()
+{
+    for (auto directory = d->changedDirectories.begin(); directory != d->changedDirectories.end();) {
+        if (d->readingDirectories.contains(*directory)) {
+            // Read again once the current read is done, it may have missed the change.
+            ++directory;
+        } else {
+            readDirectory(*directory);
+            directory = d->changedDirectories.erase(directory);
+        }
+    }
+
+    if (!d->changedDirectories.isEmpty()) {
+        d->changeTimer.start();
+    }
+}
+
+int FilesystemDocumentProvider::count() const
+{
+    return d->model->rowCount(QModelIndex());
+}
+
+QString FilesystemDocumentProvider::description() const
+{
+    //: Description for the local directories provider
+    //% "Files found in the document directories."
+    return qtTrId("sailfish-office-la-filesystem_description");
+}
+
+QUrl FilesystemDocumentProvider::icon() const
+{
+    return QUrl();
+}
+
+bool FilesystemDocumentProvider::isReady() const
+{
+    return d->ready;
+}
+
+QObject* FilesystemDocumentProvider::model() const
+{
+    return d->model;
+}
+
+QUrl FilesystemDocumentProvider::thumbnail() const
+{
+    return QUrl();
+}
+
+QString FilesystemDocumentProvider::title() const
+{
+    //: Title for the local directories provider
+    //% "Documents"
+    return qtTrId("sailfish-office-he-filesystem_title");
+}
+
+void FilesystemDocumentProvider::deleteFile(const QUrl &file)
+{
+    const QString path = file.toLocalFile();
+    if (QFile::exists(path) && QFile::remove(path)) {
+        const QString filePath = file.toString(QUrl::FullyEncoded);
+        d->model->removeAt(d->model->indexOf(filePath));
+
+        const auto files = d->files.find(QFileInfo(path).absolutePath());
+        if (files != d->files.end()) {
+            files->remove(filePath);
+        }
+    }
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2026 Caliste Damien.
+ * Contact: Damien Caliste <dcaliste@free.fr>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 only.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FILESYSTEMDOCUMENTPROVIDER_H
+#define FILESYSTEMDOCUMENTPROVIDER_H
+
+#include "documentprovider.h"
+#include "documentlistmodel.h"
+
+#include <QtCore/QStringList>
+#include <QtQml/QQmlParserStatus>
+
+// Lists the documents found in local directories, without Tracker.
+//
+// Each directory is read by a job on a thread pool, and its subdirectories are
+// read in turn. Directories are then watched for changes, a changed directory
+// being read again and compared with what is known about it. All of them are
+// also read again from time to time, to update documents edited in place.
+class FilesystemDocumentProvider : public DocumentProvider, public QQmlParserStatus
+{
+    Q_OBJECT
+    Q_INTERFACES(DocumentProvider QQmlParserStatus)
+    Q_PROPERTY(QStringList directories READ directories WRITE setDirectories NOTIFY directoriesChanged)
+
+public:
+    FilesystemDocumentProvider(QObject *parent = 0);
+    ~FilesystemDocumentProvider();
+
+    virtual int count() const;
+    virtual QUrl icon() const;
+    virtual QString title() const;
+    virtual QString description() const;
+    virtual QObject *model() const;
+    virtual QUrl thumbnail() const;
+    virtual bool isReady() const;
+
+    virtual void classBegin();
+    virtual void componentComplete();
+
+    virtual void deleteFile(const QUrl &file) Q_DECL_OVERRIDE;
+
+    // The directories searched for documents, with their subdirectories.
+    // The documents and download directories by default.
+    QStringList directories() const;
+    void setDirectories(const QStringList &directories);
+
+signals:
+    void directoriesChanged();
+
+private Q_SLOTS:
+    void addDirectory(int generation, const QString &path, const QVector<DocumentListModelEntry> &entries,
+                      const QStringList &subdirectories, bool exists);
+    void directoryChanged(const QString &path);
+    void refresh();
+    void readChangedDirectories();
+
+private:
+    void start();
+    void readDirectory(const QString &path);
+    void removeDirectory(const QString &path);
+
+    class Private;
+    Private *d;
+};
+
+#endif // FILESYSTEMDOCUMENTPROVIDER_H
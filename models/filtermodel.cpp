@@ -20,22 +20,356 @@
 
 #include "documentlistmodel.h"
 
+#include <QtCore/QAtomicInt>
+#include <QtCore/QRunnable>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QThreadPool>
+#include <QtCore/QUrl>
+
+#include <vector>
+
+namespace {
+
+// Number of documents matched by a single job.
+const int chunkSize = 2048;
+
+// Lower case, without accents, so that "Ete" finds "été".
+QString normalized(const QString &text)
+{
+    bool ascii = true;
+    for (const QChar c : text) {
+        if (c.unicode() >= 0x80) {
+            ascii = false;
+            break;
+        }
+    }
+    if (ascii) {
+        return text.toLower();
+    }
+
+    const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+    QString result;
+    result.reserve(decomposed.size());
+    for (const QChar c : decomposed) {
+        if (!c.isMark()) {
+            result.append(c.toCaseFolded());
+        }
+    }
+    return result;
+}
+
+// The text the words are looked for in. The name comes first, up to the first line feed.
+QString documentKey(const DocumentListModelEntry &entry)
+{
+    return normalized(entry.fileName + QLatin1Char('\n')
+                      + QUrl::fromPercentEncoding(entry.filePath.toUtf8()) + QLatin1Char('\n')
+                      + entry.fileType);
+}
+
+QStringList filterTokens(const QString &text)
+{
+    return normalized(text).simplified().split(QLatin1Char(' '), QString::SkipEmptyParts);
+}
+
+// Whether the characters of token appear in order in the name part of key.
+bool fuzzyMatches(const QString &key, const QString &token)
+{
+    const QChar *c = key.constData();
+    const QChar * const end = c + key.size();
+    for (const QChar t : token) {
+        while (c != end && *c != t && *c != QLatin1Char('\n')) {
+            ++c;
+        }
+        if (c == end || *c == QLatin1Char('\n')) {
+            return false;
+        }
+        ++c;
+    }
+    return true;
+}
+
+bool matches(const QString &key, const QStringList &tokens, bool fuzzy)
+{
+    for (const QString &token : tokens) {
+        if (!key.contains(token) && !(fuzzy && fuzzyMatches(key, token))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// A filter of the whole source model, shared by the jobs of its chunks.
+struct FilterRun
+{
+    QVector<DocumentListModelEntry> entries;
+    QStringList tokens;
+    bool fuzzy;
+    QVector<QString> keys;
+    bool computeKeys;
+    std::vector<char> accepted;
+    QAtomicInt remaining;
+};
+
+// Matches the documents first to last - 1 of a run on a thread of the pool, the
+// last job done telling the model.
+class FilterJob : public QRunnable
+{
+public:
+    FilterJob(QObject *receiver, const QAtomicInt *generation,
+              const QSharedPointer<FilterRun> &run, QString *keys, int first, int last)
+        : m_receiver(receiver)
+        , m_generation(generation)
+        , m_id(generation->load())
+        , m_run(run)
+        , m_keys(keys)
+        , m_first(first)
+        , m_last(last)
+    {
+    }
+
+    void run() override
+    {
+        if (m_generation->load() == m_id) {
+            const QStringList &tokens = m_run->tokens;
+            for (int i = m_first; i < m_last; ++i) {
+                if (m_run->computeKeys) {
+                    m_keys[i] = documentKey(m_run->entries.at(i));
+                }
+                m_run->accepted[i] = matches(m_keys[i], tokens, m_run->fuzzy);
+            }
+        }
+
+        if (!m_run->remaining.deref() && m_generation->load() == m_id) {
+            QMetaObject::invokeMethod(m_receiver, "filterFinished", Qt::QueuedConnection,
+                                      Q_ARG(int, m_id));
+        }
+    }
+
+private:
+    QObject * const m_receiver;
+    const QAtomicInt * const m_generation;
+    const int m_id;
+    const QSharedPointer<FilterRun> m_run;
+    QString * const m_keys;
+    const int m_first;
+    const int m_last;
+};
+
+}
+
+class FilterModel::Private
+{
+public:
+    Private()
+        : fuzzy(false)
+        , acceptedValid(false)
+        , restartPending(false)
+    {
+    }
+
+    QString filterText;
+    QStringList tokens;
+    bool fuzzy;
+    QVector<QString> keys;          // The normalized fields of each source row, when up to date.
+    std::vector<char> accepted;     // Whether each source row matches the tokens.
+    bool acceptedValid;
+    bool restartPending;            // A filter is started once the source is done changing.
+    QSharedPointer<FilterRun> run;
+    QThreadPool pool;
+    QAtomicInt generation;
+};
+
 FilterModel::FilterModel(QObject *parent)
     : QSortFilterProxyModel(parent)
+    , d(new Private)
 {
     this->setFilterRole(DocumentListModel::Roles::FileNameRole);
 }
 
 FilterModel::~FilterModel()
 {
+    d->generation.ref();
+    d->pool.waitForDone();
+
+    delete d;
 }
 
 void FilterModel::setSourceModel(DocumentListModel *model)
 {
+    if (QAbstractItemModel *previous = QSortFilterProxyModel::sourceModel()) {
+        disconnect(previous, 0, this, 0);
+    }
+
+    // Connected before the proxy itself, so that the rows it filters on a change
+    // are not looked up in stale results.
+    if (model) {
+        connect(model, &QAbstractItemModel::rowsInserted, this, &FilterModel::sourceChanged);
+        connect(model, &QAbstractItemModel::rowsRemoved, this, &FilterModel::sourceChanged);
+        connect(model, &QAbstractItemModel::rowsMoved, this, &FilterModel::sourceChanged);
+        connect(model, &QAbstractItemModel::dataChanged, this, &FilterModel::sourceChanged);
+        connect(model, &QAbstractItemModel::layoutChanged, this, &FilterModel::sourceChanged);
+        connect(model, &QAbstractItemModel::modelReset, this, &FilterModel::sourceChanged);
+    }
+
+    d->keys.clear();
+    d->acceptedValid = false;
     QSortFilterProxyModel::setSourceModel(static_cast<QAbstractItemModel*>(model));
+    startFilter();
+}
+
+QVariant FilterModel::data(const QModelIndex &index, int role) const
+{
+    if (role != MatchedPathRole) {
+        return QSortFilterProxyModel::data(index, role);
+    } else if (!index.isValid() || d->tokens.isEmpty()) {
+        return QString();
+    }
+
+    const DocumentListModelEntry &entry = sourceModel()->entryAt(mapToSource(index).row());
+    const QString key = documentKey(entry);
+    if (matches(key.left(key.indexOf(QLatin1Char('\n'))), d->tokens, d->fuzzy)) {
+        return QString();
+    }
+    return QUrl::fromPercentEncoding(entry.filePath.toUtf8());
+}
+
+QHash<int, QByteArray> FilterModel::roleNames() const
+{
+    QHash<int, QByteArray> roles = QSortFilterProxyModel::roleNames();
+    roles.insert(MatchedPathRole, "matchedPath");
+    return roles;
 }
 
 DocumentListModel* FilterModel::sourceModel() const
 {
     return static_cast<DocumentListModel*>(QSortFilterProxyModel::sourceModel());
 }
+
+QString FilterModel::filterText() const
+{
+    return d->filterText;
+}
+
+void FilterModel::setFilterText(const QString &text)
+{
+    if (d->filterText != text) {
+        d->filterText = text;
+        d->tokens = filterTokens(text);
+        startFilter();
+        emit filterTextChanged();
+    }
+}
+
+bool FilterModel::isFuzzy() const
+{
+    return d->fuzzy;
+}
+
+void FilterModel::setFuzzy(bool fuzzy)
+{
+    if (d->fuzzy != fuzzy) {
+        d->fuzzy = fuzzy;
+        startFilter();
+        emit fuzzyChanged();
+    }
+}
+
+bool FilterModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    if (d->tokens.isEmpty()) {
+        return QSortFilterProxyModel::filterAcceptsRow(sourceRow, sourceParent);
+    } else if (d->acceptedValid && size_t(sourceRow) < d->accepted.size()) {
+        return d->accepted[sourceRow];
+    }
+
+    // Rows changed while the results are computed are matched here, on the same
+    // fields as the jobs.
+    return matches(documentKey(sourceModel()->entryAt(sourceRow)), d->tokens, d->fuzzy);
+}
+
+void FilterModel::sourceChanged()
+{
+    // Results of the running filter are for the previous rows, even when a
+    // filterFinished() call is already queued.
+    d->generation.ref();
+    d->run.clear();
+    d->keys.clear();
+    d->acceptedValid = false;
+    // A source inserting its rows in several ranges is filtered once it is done.
+    if (!d->tokens.isEmpty() && !d->restartPending) {
+        d->restartPending = true;
+        QMetaObject::invokeMethod(this, "restartFilter", Qt::QueuedConnection);
+    }
+}
+
+void FilterModel::restartFilter()
+{
+    if (d->restartPending) {
+        startFilter();
+    }
+}
+
+void FilterModel::startFilter()
+{
+    d->generation.ref();
+    d->run.clear();
+    d->acceptedValid = false;
+    d->restartPending = false;
+
+    DocumentListModel *model = sourceModel();
+    if (d->tokens.isEmpty() || !model) {
+        d->accepted.clear();
+        invalidateFilter();
+        matchesChanged();
+        return;
+    }
+
+    const QSharedPointer<FilterRun> run(new FilterRun);
+    run->entries = model->snapshot();
+    run->tokens = d->tokens;
+    run->fuzzy = d->fuzzy;
+
+    const int count = run->entries.count();
+    run->computeKeys = d->keys.count() != count;
+    if (run->computeKeys) {
+        run->keys.resize(count);
+    } else {
+        run->keys = d->keys;
+    }
+    run->accepted.resize(count);
+    run->remaining.store((count + chunkSize - 1) / chunkSize);
+    d->run = run;
+
+    if (count == 0) {
+        filterFinished(d->generation.load());
+        return;
+    }
+
+    // Jobs only read the keys they do not compute, so that a shared copy stays shared.
+    QString * const keys = run->computeKeys ? run->keys.data() : const_cast<QString *>(run->keys.constData());
+    for (int first = 0; first < count; first += chunkSize) {
+        d->pool.start(new FilterJob(this, &d->generation, run, keys, first, qMin(first + chunkSize, count)));
+    }
+}
+
+void FilterModel::filterFinished(int generation)
+{
+    if (generation != d->generation.load() || !d->run) {
+        return;
+    }
+
+    d->keys = d->run->keys;
+    d->accepted.swap(d->run->accepted);
+    d->acceptedValid = true;
+    d->run.clear();
+    invalidateFilter();
+    matchesChanged();
+}
+
+void FilterModel::matchesChanged()
+{
+    const int count = rowCount();
+    if (count > 0) {
+        emit dataChanged(index(0, 0), index(count - 1, 0), QVector<int>() << MatchedPathRole);
+    }
+}
@@ -23,22 +23,67 @@
 
 #include "documentlistmodel.h"
 
+// Filters the documents of a DocumentListModel on a text typed by the user.
+//
+// The text is split in words, and a document is accepted when each word is found in
+// its name, its path or its type, ignoring case and accents. The documents are
+// matched in chunks on a thread pool against a normalized copy of these fields, kept
+// for the next filter, and the rows accepted are published at once when all chunks
+// are done. Until then, the previous rows are shown.
+//
+// The matchedPath role gives the path of the documents whose name alone doesn't
+// match, so that views can show why they are listed.
 class FilterModel : public QSortFilterProxyModel
 {
     Q_OBJECT
     Q_PROPERTY(DocumentListModel *sourceModel READ sourceModel WRITE setSourceModel NOTIFY sourceModelChanged)
+    Q_PROPERTY(QString filterText READ filterText WRITE setFilterText NOTIFY filterTextChanged)
+    Q_PROPERTY(bool fuzzy READ isFuzzy WRITE setFuzzy NOTIFY fuzzyChanged)
 public:
+    enum Roles {
+        MatchedPathRole = DocumentListModel::FileDocumentClass + 1
+    };
+
     FilterModel(QObject *parent = 0);
     ~FilterModel();
 
 public:
+    QVariant data(const QModelIndex &index, int role) const Q_DECL_OVERRIDE;
+    QHash<int, QByteArray> roleNames() const Q_DECL_OVERRIDE;
+
     DocumentListModel* sourceModel() const;
 
+    // The words looked for. When empty, the filterRegExp applies instead.
+    QString filterText() const;
+    void setFilterText(const QString &text);
+
+    // When set, a word also matches a name containing its letters in order,
+    // not only in a row.
+    bool isFuzzy() const;
+    void setFuzzy(bool fuzzy);
+
 public Q_SLOTS:
     void setSourceModel(DocumentListModel *model);
 
 Q_SIGNALS:
     void sourceModelChanged();
+    void filterTextChanged();
+    void fuzzyChanged();
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const Q_DECL_OVERRIDE;
+
+private Q_SLOTS:
+    void sourceChanged();
+    void filterFinished(int generation);
+    void restartFilter();
+
+private:
+    void startFilter();
+    void matchesChanged();
+
+    class Private;
+    Private *d;
 };
 
 #endif // FILTERMODEL_H
@@ -0,0 +1,382 @@
+/*
+ * Copyright (C) 2026 Caliste Damien.
+ * Contact: Damien Caliste <dcaliste@free.fr>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 only.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "thumbnailprovider.h"
+
+#include "pdf/pdfjob.h"
+#include "plugin/mimetypecache.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDebug>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QDirIterator>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QRunnable>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QThread>
+#include <QtCore/QUrl>
+#include <QtGui/QImageReader>
+#include <QtGui/QPainter>
+
+#include <poppler-qt5.h>
+
+#include <algorithm>
+
+namespace {
+
+// Size of the previews when the image does not ask for one.
+const int defaultWidth = 128;
+// Text read from a plain text document for its preview, in bytes.
+const qint64 textPreviewLength = 2048;
+// Keys of the cached previews, as in the freedesktop.org thumbnail specification.
+const char * const uriKey = "Thumb::URI";
+const char * const mtimeKey = "Thumb::MTime";
+// Size of the cached previews kept when pruning, in bytes.
+const qint64 cacheLimit = 32 * 1024 * 1024;
+
+// A page with some text in a system font, rendered to warm Poppler up.
+const char warmUpDocument[] =
+    "%PDF-1.4\n"
+    "1 0 obj\n"
+    "<< /Type /Catalog /Pages 2 0 R >>\n"
+    "endobj\n"
+    "2 0 obj\n"
+    "<< /Type /Pages /Kids [3 0 R] /Count 1 >>\n"
+    "endobj\n"
+    "3 0 obj\n"
+    "<< /Type /Page /Parent 2 0 R /MediaBox [0 0 32 32] /Resources << /Font << /F1 4 0 R >> >> /Contents 5 0 R >>\n"
+    "endobj\n"
+    "4 0 obj\n"
+    "<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>\n"
+    "endobj\n"
+    "5 0 obj\n"
+    "<< /Length 31 >>\n"
+    "stream\n"
+    "BT /F1 12 Tf 4 12 Td (Aa) Tj ET\n"
+    "endstream\n"
+    "endobj\n"
+    "xref\n"
+    "0 6\n"
+    "0000000000 65535 f \n"
+    "0000000009 00000 n \n"
+    "0000000058 00000 n \n"
+    "0000000115 00000 n \n"
+    "0000000239 00000 n \n"
+    "0000000309 00000 n \n"
+    "trailer\n"
+    "<< /Size 6 /Root 1 0 R >>\n"
+    "startxref\n"
+    "390\n"
+    "%%EOF\n";
+
+QImage renderPdf(const QString &path, const QSize &size)
+{
+    LoadDocumentJob load(path);
+    load.run();
+    Poppler::Document *document = load.document();
+    if (!document) {
+        return QImage();
+    }
+
+    QImage image;
+    if (!document->isLocked() && document->numPages() > 0) {
+        Poppler::Page *page = document->page(0);
+        const QSizeF pageSize = page->pageSizeF();
+        delete page;
+
+        int width = size.width();
+        if (pageSize.height() * width > pageSize.width() * size.height()) {
+            width = qMax(1, int(pageSize.width() * size.height() / pageSize.height()));
+        }
+
+        RenderPageJob render(0, width, nullptr);
+        render.setDocument(document);
+        render.run();
+        image = render.m_image;
+    }
+
+    delete document;
+    return image;
+}
+
+QImage renderText(const QString &path, const QSize &size)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QImage();
+    }
+    const QString text = QString::fromUtf8(file.read(textPreviewLength));
+
+    QImage image(size, QImage::Format_RGB32);
+    image.fill(Qt::white);
+
+    QPainter painter(&image);
+    QFont font = painter.font();
+    font.setPixelSize(qMax(4, size.width() / 16));
+    painter.setFont(font);
+    painter.setPen(Qt::black);
+
+    const int margin = qMax(1, size.width() / 16);
+    painter.drawText(image.rect().adjusted(margin, margin, -margin, -margin),
+                     Qt::AlignLeft | Qt::AlignTop | Qt::TextWordWrap, text);
+    return image;
+}
+
+class WarmUpJob : public QRunnable
+{
+public:
+    void run() override
+    {
+        // Poppler reads its global parameters and looks the system fonts up with
+        // the first document.
+        Poppler::Document *document = Poppler::Document::loadFromData(
+                    QByteArray::fromRawData(warmUpDocument, sizeof(warmUpDocument) - 1));
+        if (document) {
+            document->setRenderHint(Poppler::Document::Antialiasing, true);
+            document->setRenderHint(Poppler::Document::TextAntialiasing, true);
+            if (Poppler::Page *page = document->page(0)) {
+                page->renderToImage();
+                delete page;
+            }
+            delete document;
+        }
+    }
+};
+
+QString cacheRoot()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/thumbnails");
+}
+
+class PruneJob : public QRunnable
+{
+public:
+    explicit PruneJob(const QAtomicInt *stopped)
+        : m_stopped(stopped)
+    {
+    }
+
+    void run() override
+    {
+        // The previews of removed documents go first, then the least recently
+        // written ones until the cache fits.
+        QList<QFileInfo> previews;
+        QDirIterator it(cacheRoot(), QStringList() << QStringLiteral("*.png"), QDir::Files,
+                        QDirIterator::Subdirectories);
+        while (it.hasNext() && !m_stopped->load()) {
+            it.next();
+            const QString uri = QImageReader(it.filePath(), "png").text(uriKey);
+            const QString path = QUrl(uri).toLocalFile();
+            if (path.isEmpty() || !QFile::exists(path)) {
+                QFile::remove(it.filePath());
+            } else {
+                previews.append(it.fileInfo());
+            }
+        }
+
+        std::sort(previews.begin(), previews.end(), [](const QFileInfo &left, const QFileInfo &right) {
+            return left.lastModified() > right.lastModified();
+        });
+        qint64 size = 0;
+        for (const QFileInfo &preview : previews) {
+            size += preview.size();
+            if (size > cacheLimit) {
+                QFile::remove(preview.filePath());
+            }
+        }
+    }
+
+private:
+    const QAtomicInt *m_stopped;
+};
+
+class ThumbnailResponse : public QQuickImageResponse, public QRunnable
+{
+public:
+    ThumbnailResponse(const QString &id, const QSize &requestedSize,
+                      QMutex *queueMutex, QSet<QQuickImageResponse *> *queue)
+        : m_id(id)
+        , m_size(requestedSize)
+        , m_queueMutex(queueMutex)
+        , m_queue(queue)
+    {
+        setAutoDelete(false);
+
+        if (m_size.width() <= 0 && m_size.height() <= 0) {
+            m_size = QSize(defaultWidth, defaultWidth * 3 / 2);
+        } else if (m_size.width() <= 0) {
+            m_size.setWidth(m_size.height() * 2 / 3);
+        } else if (m_size.height() <= 0) {
+            m_size.setHeight(m_size.width() * 3 / 2);
+        }
+    }
+
+    QQuickTextureFactory *textureFactory() const override
+    {
+        return QQuickTextureFactory::textureFactoryForImage(m_image);
+    }
+
+    QString errorString() const override
+    {
+        return m_error;
+    }
+
+    void cancel() override
+    {
+        m_cancelled.store(1);
+    }
+
+    void run() override
+    {
+        {
+            QMutexLocker locker(m_queueMutex);
+            m_queue->remove(this);
+        }
+
+        if (!m_cancelled.load()) {
+            m_image = thumbnail();
+        }
+        if (m_image.isNull() && m_error.isEmpty()) {
+            m_error = m_cancelled.load() ? QStringLiteral("Cancelled") : QStringLiteral("No preview");
+        }
+        emit finished();
+    }
+
+private:
+    QImage thumbnail()
+    {
+        // The file URL is percent-encoded as a whole, so that its own escapes and
+        // characters like '#' or '?' are kept.
+        const QString url = QUrl::fromPercentEncoding(m_id.toUtf8());
+        QString path = QUrl(url).toLocalFile();
+        if (path.isEmpty()) {
+            path = url;
+        }
+
+        const QString uri = QString::fromUtf8(QUrl::fromLocalFile(path).toEncoded());
+        const QString directory = cacheRoot()
+                + QStringLiteral("/%1x%2").arg(m_size.width()).arg(m_size.height());
+        const QString cacheFile = directory + QLatin1Char('/')
+                + QString::fromLatin1(QCryptographicHash::hash(uri.toUtf8(), QCryptographicHash::Md5).toHex())
+                + QStringLiteral(".png");
+
+        const QFileInfo info(path);
+        if (!info.isFile()) {
+            QFile::remove(cacheFile);
+            m_error = QStringLiteral("No such file");
+            return QImage();
+        }
+
+        const QString mtime = QString::number(info.lastModified().toMSecsSinceEpoch() / 1000);
+        bool stale = false;
+        {
+            QImageReader reader(cacheFile, "png");
+            if (reader.canRead()) {
+                if (reader.text(mtimeKey) == mtime && reader.text(uriKey) == uri) {
+                    const QImage image = reader.read();
+                    if (!image.isNull()) {
+                        return image;
+                    }
+                }
+                stale = true;
+            }
+        }
+        // Dropped now, in case the document can't be rendered any more.
+        if (stale) {
+            QFile::remove(cacheFile);
+        }
+
+        if (m_cancelled.load()) {
+            return QImage();
+        }
+
+        const QMimeType type = MimeTypeCache::mimeTypeForFile(info).mimeType;
+        QImage image;
+        if (type.name() == QLatin1String("application/pdf")) {
+            image = renderPdf(path, m_size);
+        } else if (type.inherits(QStringLiteral("text/plain"))) {
+            image = renderText(path, m_size);
+        }
+        if (image.isNull()) {
+            return image;
+        }
+
+        image.setText(uriKey, uri);
+        image.setText(mtimeKey, mtime);
+        QSaveFile file(cacheFile);
+        if (QDir().mkpath(directory) && file.open(QIODevice::WriteOnly)) {
+            if (!image.save(&file, "png") || !file.commit()) {
+                qWarning() << "Cannot save the preview of" << path;
+            }
+        }
+        return image;
+    }
+
+    const QString m_id;
+    QSize m_size;
+    QImage m_image;
+    QString m_error;
+    QAtomicInt m_cancelled;
+    QMutex *m_queueMutex;
+    QSet<QQuickImageResponse *> *m_queue;
+};
+
+}
+
+ThumbnailProvider::ThumbnailProvider()
+{
+    // Leave some room to the GUI and to the documents being read.
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+}
+
+ThumbnailProvider::~ThumbnailProvider()
+{
+    // QML deletes a response only once it has finished: the queued ones are
+    // run cancelled rather than dropped from the pool, which would leak them.
+    m_stopped.store(1);
+    {
+        QMutexLocker locker(&m_queueMutex);
+        for (QQuickImageResponse *response : m_queue) {
+            response->cancel();
+        }
+    }
+    m_pool.waitForDone();
+}
+
+void ThumbnailProvider::warmUp()
+{
+    m_pool.start(new WarmUpJob);
+    // Behind every preview requested meanwhile.
+    m_pool.start(new PruneJob(&m_stopped), -1);
+}
+
+QQuickImageResponse *ThumbnailProvider::requestImageResponse(const QString &id, const QSize &requestedSize)
+{
+    ThumbnailResponse *response = new ThumbnailResponse(id, requestedSize, &m_queueMutex, &m_queue);
+    {
+        QMutexLocker locker(&m_queueMutex);
+        m_queue.insert(response);
+    }
+    // A higher priority runs first: the last request is rendered before the previous ones.
+    m_pool.start(response, m_order.fetchAndAddRelaxed(1));
+    return response;
+}
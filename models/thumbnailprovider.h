@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2026 Caliste Damien.
+ * Contact: Damien Caliste <dcaliste@free.fr>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 only.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef THUMBNAILPROVIDER_H
+#define THUMBNAILPROVIDER_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QMutex>
+#include <QtCore/QSet>
+#include <QtCore/QThreadPool>
+#include <QtQuick/QQuickAsyncImageProvider>
+
+// Serves previews of the first page of PDF and plain text documents, as
+// "image://thumbnail/<file url>".
+//
+// Previews are rendered on a thread pool, the most recent requests first since
+// they come from the rows just scrolled into view. Requests of images that are
+// gone are dropped before being rendered. Rendered previews are saved in the
+// cache directory, and reused as long as the document is not modified. The
+// cache is pruned of the previews of removed documents, and of the oldest
+// previews past a size limit, when warming up.
+class ThumbnailProvider : public QQuickAsyncImageProvider
+{
+public:
+    ThumbnailProvider();
+    ~ThumbnailProvider();
+
+    // Initializes Poppler and its fonts on a thread of the pool, ahead of the
+    // first document, and prunes the cached previews.
+    void warmUp();
+
+    QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize) Q_DECL_OVERRIDE;
+
+private:
+    QThreadPool m_pool;
+    QAtomicInt m_order;
+    QAtomicInt m_stopped;
+    // Responses waiting for a thread, finished as cancelled on destruction.
+    QMutex m_queueMutex;
+    QSet<QQuickImageResponse *> m_queue;
+};
+
+#endif // THUMBNAILPROVIDER_H
@@ -17,12 +17,19 @@
  */
 
 #include "trackerdocumentprovider.h"
-#include "documentlistmodel.h"
 
 #include <QDir>
 #include <QtCore/qthreadpool.h>
+#include <QtCore/QAtomicInt>
+#include <QtCore/QDataStream>
+#include <QtCore/QDebug>
 #include <QtCore/QModelIndex>
+#include <QtCore/QSaveFile>
+#include <QtCore/QSet>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QTimer>
 #include <QtDBus/QDBusConnection>
+#include <QtDBus/QDBusMetaType>
 
 #include <qglobal.h>
 
@@ -35,12 +42,13 @@
 //The Tracker driver to use.
 static const QString trackerDriver{"QTRACKER"};
 
-//The query to run to get files out of Tracker.
+//The query to run to get files out of Tracker, %1 is an additional filter and %2
+//the solution modifiers.
 static const QString documentQuery{
 "PREFIX nfo: <http://www.semanticdesktop.org/ontologies/2007/03/22/nfo#> "
 "PREFIX nie: <http://www.semanticdesktop.org/ontologies/2007/01/19/nie#> "
 "PREFIX nco: <http://www.semanticdesktop.org/ontologies/2007/03/22/nco#> "
-"SELECT ?name ?path ?size ?lastAccessed ?mimeType WHERE { "
+"SELECT tracker:id(?u) ?name ?path ?size ?lastAccessed ?mimeType WHERE { "
     "?u nfo:fileName ?name . "
     "?u nie:url ?path . "
     "?u nfo:fileSize ?size . "
@@ -51,45 +59,226 @@ static const QString documentQuery{
     "UNION { ?u a nfo:TextDocument . ?u nie:mimeType 'text/plain' FILTER(fn:ends-with(nfo:fileName(?u),'.txt')) } "
     "UNION { ?u a nfo:Presentation } "
     "UNION { ?u a nfo:Spreadsheet } "
-"}"
+    "%1 "
+"} %2"
 };
 
+//Documents are fetched in pages of pageSize, by increasing Tracker id.
+static const QString pageFilter{"FILTER(tracker:id(?u) > %1)"};
+static const QString pageModifiers{"ORDER BY tracker:id(?u) LIMIT %1"};
+static const int pageSize = 500;
+
+//The filter restricting the query to the changed resources.
+static const QString changedFilter{"FILTER(tracker:id(?u) IN (%1))"};
+
+//Changes are collected for that long before being queried, in ms.
+static const int updateDelay = 500;
+
+//Beyond that many changed resources, everything is queried again.
+static const int maximumUpdateCount = 200;
+
 //Strings used for the DBus connection to listen to Tracker's GraphUpdated signal.
 static const QString dbusService{"org.freedesktop.Tracker1"};
 static const QString dbusPath{"/org/freedesktop/Tracker1/Resources"};
 static const QString dbusInterface{"org.freedesktop.Tracker1.Resources"};
 static const QString dbusSignal{"GraphUpdated"};
 
+//The last known documents are kept there, to show them before Tracker answers.
+static const QString cacheFileName{"documents.cache"};
+static const quint32 cacheMagic = 0x534f4443; // "SODC"
+static const quint32 cacheVersion = 3;  // 2: canonical document paths, 3: read time in ms.
+
 //The semantic class for all document types.
 static const QString documentClassName("http://www.semanticdesktop.org/ontologies/2007/03/22/nfo#Document");
 
+//Documents are stored with the encoding of QUrl::fromLocalFile(), as by the other
+//providers, so a file is found whatever the encoding of the URL referring to it.
+static QString documentPath(const QUrl &url)
+{
+    return url.isLocalFile()
+            ? QUrl::fromLocalFile(url.toLocalFile()).toString(QUrl::FullyEncoded)
+            : url.toString(QUrl::FullyEncoded);
+}
+
+// Runs the document query page by page with its own connection, and hands each page to
+// the provider. The main thread then only has to merge a page at a time in the model.
+class TrackerSearchJob : public QRunnable
+{
+public:
+    TrackerSearchJob(QObject *receiver, const QAtomicInt *generation)
+        : m_receiver(receiver)
+        , m_generation(generation)
+        , m_id(generation->load())
+    {
+    }
+
+    void run() override
+    {
+        QSparqlConnection connection(trackerDriver);
+        int lastId = 0;
+        bool last = false;
+
+        // Stop as soon as another search started, or the provider is destroyed.
+        while (!last && m_generation->load() == m_id) {
+            QSparqlResult *result = connection.syncExec(
+                        QSparqlQuery(documentQuery.arg(pageFilter.arg(lastId), pageModifiers.arg(pageSize))));
+
+            QVector<DocumentListModelEntry> entries;
+            QVector<int> ids;
+            int count = 0;
+            while (result->next()) {
+                DocumentListModelEntry entry;
+                entry.fileName = result->binding(1).value().toString();
+                entry.filePath = documentPath(QUrl(result->binding(2).value().toString()));
+                entry.fileType = entry.filePath.split('.').last();
+                entry.fileSize = result->binding(3).value().toInt();
+                entry.readTime = result->binding(4).value().toDateTime().toMSecsSinceEpoch();
+                entry.mimeType = result->binding(5).value().toString();
+                entries.append(entry);
+
+                lastId = result->binding(0).value().toInt();
+                ids.append(lastId);
+                ++count;
+            }
+            const bool failed = result->hasError();
+            delete result;
+
+            last = failed || count < pageSize;
+            QMetaObject::invokeMethod(m_receiver, "addSearchPage", Qt::QueuedConnection,
+                                      Q_ARG(int, m_id),
+                                      Q_ARG(QVector<DocumentListModelEntry>, entries),
+                                      Q_ARG(QVector<int>, ids),
+                                      Q_ARG(bool, last),
+                                      Q_ARG(bool, failed));
+        }
+    }
+
+private:
+    QObject * const m_receiver;
+    const QAtomicInt * const m_generation;
+    const int m_id;
+};
+
 class TrackerDocumentProvider::Private {
 public:
     Private()
         : model(new DocumentListModel)
         , connection{nullptr}
         , ready(false)
+        , searching(false)
+        , cacheChanged(false)
     {
         model->setObjectName("TrackerDocumentList");
+
+        updateTimer.setSingleShot(true);
+        updateTimer.setInterval(updateDelay);
+
+        // One search at a time, a cancelled one stops after its current page.
+        searchPool.setMaxThreadCount(1);
     }
 
     ~Private() {
         model->deleteLater();
     }
 
+    QString cachePath() const
+    {
+        return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1Char('/') + cacheFileName;
+    }
+
+    void loadCache()
+    {
+        QFile file(cachePath());
+        if (!file.open(QIODevice::ReadOnly)) {
+            return;
+        }
+
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_5_6);
+
+        quint32 magic = 0;
+        quint32 version = 0;
+        QVector<DocumentListModelEntry> entries;
+        stream >> magic >> version;
+        if (magic != cacheMagic || version != cacheVersion) {
+            return;
+        }
+        stream >> entries;
+        if (stream.status() == QDataStream::Ok) {
+            model->applySnapshot(entries);
+        }
+    }
+
+    void saveCache()
+    {
+        QDir().mkpath(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+
+        QSaveFile file(cachePath());
+        if (!file.open(QIODevice::WriteOnly)) {
+            qWarning() << "Can't write the document cache" << file.fileName() << ":" << file.errorString();
+            return;
+        }
+
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_5_6);
+        stream << cacheMagic << cacheVersion << model->snapshot();
+
+        if (file.commit()) {
+            cacheChanged = false;
+        }
+    }
+
     DocumentListModel *model;
     QSparqlConnection *connection;
     bool ready;
+    bool searching;
+    bool cacheChanged;  // The model changed since the cache was written.
+    QHash<int, QString> paths;  // Path of the documents in the model, by Tracker id.
+    QHash<int, QString> searchPaths;    // The same for the search in progress.
+    QSet<int> changedIds;       // Resources changed since the last query.
+    QSet<int> updatingIds;      // Resources being queried.
+    QTimer updateTimer;
+    QThreadPool searchPool;
+    QAtomicInt searchGeneration;
 };
 
+QDBusArgument &operator<<(QDBusArgument &argument, const TrackerQuad &quad)
+{
+    argument.beginStructure();
+    argument << quad.graph << quad.subject << quad.predicate << quad.object;
+    argument.endStructure();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, TrackerQuad &quad)
+{
+    argument.beginStructure();
+    argument >> quad.graph >> quad.subject >> quad.predicate >> quad.object;
+    argument.endStructure();
+    return argument;
+}
+
 TrackerDocumentProvider::TrackerDocumentProvider(QObject *parent)
     : DocumentProvider(parent)
     , d(new Private)
 {
+    qRegisterMetaType<QVector<DocumentListModelEntry> >();
+
+    connect(&d->updateTimer, &QTimer::timeout, this, &TrackerDocumentProvider::startUpdate);
+
+    // Show the documents found last time until Tracker has answered.
+    d->loadCache();
 }
 
 TrackerDocumentProvider::~TrackerDocumentProvider()
 {
+    d->searchGeneration.ref();
+    d->searchPool.waitForDone();
+
+    if (d->cacheChanged) {
+        d->saveCache();
+    }
+
     delete d->connection;
     delete d;
 }
@@ -100,8 +289,12 @@ void TrackerDocumentProvider::classBegin()
 
 void TrackerDocumentProvider::componentComplete()
 {
+    qDBusRegisterMetaType<TrackerQuad>();
+    qDBusRegisterMetaType<TrackerQuadList>();
+
     QDBusConnection sessionBus = QDBusConnection::sessionBus();
-    sessionBus.connect(dbusService, dbusPath, dbusInterface, dbusSignal, this, SLOT(trackerGraphChanged(QString,QVariantList,QVariantList)));
+    sessionBus.connect(dbusService, dbusPath, dbusInterface, dbusSignal, this,
+                       SLOT(trackerGraphChanged(QString,TrackerQuadList,TrackerQuadList)));
 
     d->connection = new QSparqlConnection(trackerDriver);
     startSearch();
@@ -109,40 +302,134 @@ void TrackerDocumentProvider::componentComplete()
 
 void TrackerDocumentProvider::startSearch()
 {
-    QSparqlQuery q(documentQuery);
-    QSparqlResult* result = d->connection->exec(q);
-    connect(result, SIGNAL(finished()), this, SLOT(searchFinished()));
+    // Whatever changed so far is part of the result.
+    d->changedIds.clear();
+    d->searching = true;
+    d->searchPaths.clear();
+
+    // The entries which aren't found again are removed when the search is done.
+    d->model->setAllItemsDirty(true);
+
+    d->searchGeneration.ref();
+    d->searchPool.start(new TrackerSearchJob(this, &d->searchGeneration));
 }
 
 void TrackerDocumentProvider::stopSearch()
 {
+    d->searchGeneration.ref();
+    if (d->searching) {
+        d->searching = false;
+        d->searchPaths.clear();
+        d->model->setAllItemsDirty(false);
+    }
+}
+
+void TrackerDocumentProvider::addSearchPage(int generation, const QVector<DocumentListModelEntry> &entries,
+                                            const QVector<int> &ids, bool last, bool failed)
+{
+    if (generation != d->searchGeneration.load()) {
+        // From a cancelled search.
+        return;
+    }
+
+    d->model->addItems(entries);
+    for (int i = 0; i < ids.count(); ++i) {
+        d->searchPaths.insert(ids.at(i), entries.at(i).filePath);
+    }
+
+    if (!last) {
+        emit countChanged();
+        return;
+    }
+
+    d->searching = false;
+    if (!failed) {
+        d->model->removeItemsDirty();
+        d->paths.swap(d->searchPaths);
+        d->saveCache();
+        if (!d->ready) {
+            d->ready = true;
+            emit readyChanged();
+        }
+    } else {
+        // Keep what is known.
+        d->model->setAllItemsDirty(false);
+        for (auto path = d->searchPaths.constBegin(); path != d->searchPaths.constEnd(); ++path) {
+            d->paths.insert(path.key(), path.value());
+        }
+    }
+    d->searchPaths.clear();
+
+    if (!d->changedIds.isEmpty()) {
+        d->updateTimer.start();
+    }
+
+    emit countChanged();
 }
 
-void TrackerDocumentProvider::searchFinished()
+void TrackerDocumentProvider::startUpdate()
+{
+    if (d->searching || !d->updatingIds.isEmpty()) {
+        // Started again once the current query is done.
+        return;
+    } else if (d->changedIds.count() > maximumUpdateCount) {
+        startSearch();
+        return;
+    }
+
+    QStringList ids;
+    for (int id : d->changedIds) {
+        ids.append(QString::number(id));
+    }
+    d->updatingIds = d->changedIds;
+    d->changedIds.clear();
+
+    QSparqlQuery q(documentQuery.arg(changedFilter.arg(ids.join(QLatin1Char(','))), QString()));
+    QSparqlResult* result = d->connection->exec(q);
+    connect(result, SIGNAL(finished()), this, SLOT(updateFinished()));
+}
+
+void TrackerDocumentProvider::updateFinished()
 {
     QSparqlResult *r = qobject_cast<QSparqlResult*>(sender());
     if (!r->hasError()) {
-        // d->model->clear();
-        // Mark all current entries in the model dirty.
-        d->model->setAllItemsDirty(true);
+        // The changed resources which aren't found aren't documents anymore.
+        QSet<int> removedIds = d->updatingIds;
         while (r->next()) {
-            // This will remove the dirty flag for already
-            // existing entries.
+            const int id = r->binding(0).value().toInt();
+            const QString path = documentPath(QUrl(r->binding(2).value().toString()));
+            const QString previousPath = d->paths.value(id);
+            if (!previousPath.isEmpty() && previousPath != path) {
+                d->model->removeAt(d->model->indexOf(previousPath));
+            }
+            removedIds.remove(id);
+            d->paths.insert(id, path);
+
             d->model->addItem(
-                r->binding(0).value().toString(),
                 r->binding(1).value().toString(),
-                r->binding(1).value().toString().split('.').last(),
-                r->binding(2).value().toInt(),
-                r->binding(3).value().toDateTime(),
-                r->binding(4).value().toString()
+                path,
+                path.split('.').last(),
+                r->binding(3).value().toInt(),
+                r->binding(4).value().toDateTime(),
+                r->binding(5).value().toString()
             );
         }
-        // Remove all entries with the dirty mark.
-        d->model->removeItemsDirty();
-        if (!d->ready) {
-            d->ready = true;
-            emit readyChanged();
+        for (int id : removedIds) {
+            const QString path = d->paths.take(id);
+            if (!path.isEmpty()) {
+                d->model->removeAt(d->model->indexOf(path));
+            }
         }
+        d->cacheChanged = true;
+    } else {
+        // Try again with everything.
+        d->changedIds += d->updatingIds;
+    }
+    r->deleteLater();
+
+    d->updatingIds.clear();
+    if (!d->changedIds.isEmpty()) {
+        d->updateTimer.start();
     }
 
     emit countChanged();
@@ -193,19 +480,27 @@ void TrackerDocumentProvider::deleteFile(const QUrl &file)
     if (QFile::exists(file.toLocalFile())) {
         QFile::remove(file.toLocalFile());
 
-        const int count = d->model->rowCount(QModelIndex());
-        for (int i = 0; i < count; ++i) {
-            if (d->model->data(d->model->index(i, 0), DocumentListModel::FilePathRole).toUrl() == file) {
-                d->model->removeAt(i);
-                break;
-            }
-        }
+        d->model->removeAt(d->model->indexOf(documentPath(file)));
+        d->cacheChanged = true;
     }
 }
 
-void TrackerDocumentProvider::trackerGraphChanged(const QString &className, const QVariantList&, const QVariantList&)
+void TrackerDocumentProvider::trackerGraphChanged(const QString &className, const TrackerQuadList &deletes, const TrackerQuadList &inserts)
 {
-    if (className == documentClassName) {
-        startSearch();
+    if (className != documentClassName) {
+        return;
+    }
+
+    for (const TrackerQuad &quad : deletes) {
+        d->changedIds.insert(quad.subject);
+    }
+    for (const TrackerQuad &quad : inserts) {
+        d->changedIds.insert(quad.subject);
+    }
+
+    // Bursts of changes are queried together, the timer isn't restarted so they don't
+    // delay the update forever.
+    if (!d->updateTimer.isActive()) {
+        d->updateTimer.start();
     }
 }
@@ -20,13 +20,30 @@
 #define TRACKERDOCUMENTPROVIDER_H
 
 #include "documentprovider.h"
+#include "documentlistmodel.h"
 
 #include <QtCore/QFileInfo>
 #include <QtCore/QRunnable>
 #include <QtCore/QHash>
+#include <QtDBus/QDBusArgument>
 #include <QtQml/QQmlParserStatus>
 
-class DocumentListModel;
+// A change notified by Tracker's GraphUpdated signal, as resource ids.
+struct TrackerQuad
+{
+    int graph;
+    int subject;
+    int predicate;
+    int object;
+};
+typedef QList<TrackerQuad> TrackerQuadList;
+
+QDBusArgument &operator<<(QDBusArgument &argument, const TrackerQuad &quad);
+const QDBusArgument &operator>>(const QDBusArgument &argument, TrackerQuad &quad);
+
+Q_DECLARE_METATYPE(TrackerQuad)
+Q_DECLARE_METATYPE(TrackerQuadList)
+
 class TrackerDocumentProvider : public DocumentProvider, public QQmlParserStatus
 {
     Q_OBJECT
@@ -59,8 +76,11 @@ public Q_SLOTS:
     void stopSearch();
 
 private Q_SLOTS:
-    void searchFinished();
-    void trackerGraphChanged(const QString &className, const QVariantList&, const QVariantList&);
+    void addSearchPage(int generation, const QVector<DocumentListModelEntry> &entries,
+                       const QVector<int> &ids, bool last, bool failed);
+    void updateFinished();
+    void trackerGraphChanged(const QString &className, const TrackerQuadList &deletes, const TrackerQuadList &inserts);
+    void startUpdate();
 
 private:
     class Private;
@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2026 Caliste Damien.
+ * Contact: Damien Caliste <dcaliste@free.fr>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 only.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+// Offscreen benchmark of the PDF rendering engine. It drives
+// PDFRenderThread and the PDF jobs over a set of documents and
+// prints the measures as JSON on the standard output.
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <sys/resource.h>
+#include <stdio.h>
+
+#include "pdfrenderthread.h"
+#include "pdfjob.h"
+
+namespace {
+
+// Elapsed time in milliseconds.
+qreal elapsed(qint64 since)
+{
+    return (PDFJob::timestamp() - since) / 1000.;
+}
+
+// Peak resident set size in kilobytes.
+qint64 peakRss()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+bool load(PDFRenderThread *thread, const QString &fileName)
+{
+    QEventLoop loop;
+    QObject::connect(thread, &PDFRenderThread::loadFinished, &loop, &QEventLoop::quit);
+    thread->queueJob(new LoadDocumentJob(fileName));
+    loop.exec();
+
+    return !thread->isFailed() && !thread->isLocked();
+}
+
+// Renders the given pages and returns once they are all done.
+void render(PDFRenderThread *thread, int first, int count, uint width)
+{
+    QEventLoop loop;
+    int remaining = count;
+    QObject::connect(thread, &PDFRenderThread::jobFinished, &loop, [&](PDFJob *job) {
+        job->deleteLater();
+        if (--remaining == 0)
+            loop.quit();
+    });
+    for (int i = first; i < first + count; ++i)
+        thread->queueJob(new RenderPageJob(i, width, nullptr));
+    loop.exec();
+}
+
+int search(PDFRenderThread *thread, const QString &text)
+{
+    QEventLoop loop;
+    int matches = 0;
+    QObject::connect(thread, &PDFRenderThread::searchProgress, &loop,
+                     [&](float, const QList<QPair<int, QRectF>> &newMatches) {
+        matches += newMatches.count();
+    });
+    QObject::connect(thread, &PDFRenderThread::searchFinished, &loop, &QEventLoop::quit);
+    thread->search(text, 0);
+    loop.exec();
+
+    return matches;
+}
+
+QJsonObject benchmark(const QString &fileName, const QList<uint> &widths, const QString &searchText)
+{
+    QJsonObject result;
+    result.insert(QStringLiteral("file"), fileName);
+    result.insert(QStringLiteral("size"), QFileInfo(fileName).size());
+
+    PDFRenderThread thread;
+
+    qint64 start = PDFJob::timestamp();
+    if (!load(&thread, fileName)) {
+        result.insert(QStringLiteral("error"), thread.isLocked()
+                      ? QStringLiteral("locked") : QStringLiteral("load failure"));
+        return result;
+    }
+    result.insert(QStringLiteral("openTime"), elapsed(start));
+
+    const int pageCount = thread.pageCount();
+    result.insert(QStringLiteral("pages"), pageCount);
+
+    start = PDFJob::timestamp();
+    render(&thread, 0, 1, widths.first());
+    result.insert(QStringLiteral("firstPageTime"), elapsed(start));
+
+    QJsonArray renders;
+    for (uint width : widths) {
+        start = PDFJob::timestamp();
+        render(&thread, 0, pageCount, width);
+        const qreal time = elapsed(start);
+
+        QJsonObject measure;
+        measure.insert(QStringLiteral("width"), int(width));
+        measure.insert(QStringLiteral("time"), time);
+        measure.insert(QStringLiteral("pagesPerSecond"), time > 0. ? pageCount * 1000. / time : 0.);
+        renders.append(measure);
+    }
+    result.insert(QStringLiteral("render"), renders);
+
+    if (!searchText.isEmpty()) {
+        start = PDFJob::timestamp();
+        const int matches = search(&thread, searchText);
+        const qreal time = elapsed(start);
+
+        QJsonObject measure;
+        measure.insert(QStringLiteral("text"), searchText);
+        measure.insert(QStringLiteral("matches"), matches);
+        measure.insert(QStringLiteral("time"), time);
+        measure.insert(QStringLiteral("pagesPerSecond"), time > 0. ? pageCount * 1000. / time : 0.);
+        result.insert(QStringLiteral("search"), measure);
+    }
+
+    start = PDFJob::timestamp();
+    int boxes = 0;
+    for (int i = 0; i < pageCount; ++i)
+        boxes += thread.textBoxesAtPage(i).count();
+    result.insert(QStringLiteral("textTime"), elapsed(start));
+    result.insert(QStringLiteral("textBoxes"), boxes);
+
+    result.insert(QStringLiteral("peakRss"), peakRss());
+
+    return result;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName(QStringLiteral("pdf-bench"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Benchmark the PDF rendering of Sailfish Office."));
+    parser.addHelpOption();
+    QCommandLineOption widthsOption(QStringLiteral("widths"),
+                                    QStringLiteral("Comma separated page widths to render at."),
+                                    QStringLiteral("widths"), QStringLiteral("540,1080"));
+    QCommandLineOption searchOption(QStringLiteral("search"),
+                                    QStringLiteral("Text to search for in each document."),
+                                    QStringLiteral("text"), QStringLiteral("the"));
+    parser.addOption(widthsOption);
+    parser.addOption(searchOption);
+    parser.addPositionalArgument(QStringLiteral("files"),
+                                 QStringLiteral("PDF files, or directories containing PDF files."));
+    parser.process(app);
+
+    QList<uint> widths;
+    for (const QString &width : parser.value(widthsOption).split(QLatin1Char(','), QString::SkipEmptyParts)) {
+        if (width.toUInt() > 0)
+            widths.append(width.toUInt());
+    }
+
+    QStringList files;
+    for (const QString &argument : parser.positionalArguments()) {
+        QFileInfo info(argument);
+        if (info.isDir()) {
+            QDir dir(argument);
+            for (const QFileInfo &file : dir.entryInfoList(QStringList() << QStringLiteral("*.pdf"),
+                                                            QDir::Files, QDir::Name))
+                files.append(file.absoluteFilePath());
+        } else {
+            files.append(info.absoluteFilePath());
+        }
+    }
+
+    if (files.isEmpty() || widths.isEmpty())
+        parser.showHelp(1);
+
+    QJsonArray results;
+    for (const QString &file : files)
+        results.append(benchmark(file, widths, parser.value(searchOption)));
+
+    fputs(QJsonDocument(results).toJson().constData(), stdout);
+
+    return 0;
+}
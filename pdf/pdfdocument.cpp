@@ -20,6 +20,7 @@
 #include "pdfrenderthread.h"
 #include "pdfjob.h"
 #include "pdfsearchmodel.h"
+#include "pdfrenderstats.h"
 
 #include <QDebug>
 #include <QUrl>
@@ -38,6 +39,7 @@ public:
     }
 
     PDFRenderThread *thread;
+    PDFRenderStats *renderStats;
 
     bool searching;
     PDFSearchModel *searchModel;
@@ -52,6 +54,7 @@ PDFDocument::PDFDocument(QObject *parent)
     : QObject(parent), d(new Private)
 {
     d->thread = new PDFRenderThread(this);
+    d->renderStats = new PDFRenderStats(this);
     connect(d->thread, &PDFRenderThread::loadFinished, this, &PDFDocument::documentLoadedChanged);
     connect(d->thread, &PDFRenderThread::loadFinished, this, &PDFDocument::pageCountChanged);
     connect(d->thread, &PDFRenderThread::loadFinished, this, &PDFDocument::loadFinished);
@@ -97,6 +100,11 @@ QObject* PDFDocument::searchModel() const
     return d->searchModel;
 }
 
+QObject* PDFDocument::renderStats() const
+{
+    return d->renderStats;
+}
+
 bool PDFDocument::searching() const
 {
     return d->searching;
@@ -236,7 +244,7 @@ void PDFDocument::cancelPageRequest(int index)
 {
     if (!isLoaded() || isLocked())
         return;
-    d->thread->cancelRenderJob(index);
+    d->renderStats->addCancelled(index, d->thread->cancelRenderJob(index));
 }
 
 void PDFDocument::requestPageSizes()
@@ -314,6 +322,7 @@ void PDFDocument::jobFinished(PDFJob *job)
     }
     case PDFJob::RenderPageJob: {
         RenderPageJob* j = static_cast<RenderPageJob*>(job);
+        d->renderStats->addRenderJob(j);
         emit pageFinished(j->m_index, j->renderWidth(), j->m_subpart,
                           j->m_page, j->m_extraData);
         break;
@@ -43,6 +43,7 @@ class PDFDocument : public QObject, public QQmlParserStatus
     Q_PROPERTY(bool modified READ isModified NOTIFY documentModifiedChanged)
     Q_PROPERTY(bool searching READ searching NOTIFY searchingChanged)
     Q_PROPERTY(QObject* searchModel READ searchModel NOTIFY searchModelChanged)
+    Q_PROPERTY(QObject* renderStats READ renderStats CONSTANT)
 
     Q_INTERFACES(QQmlParserStatus)
 
@@ -60,6 +61,7 @@ public:
     QObject* tocModel() const;
     bool searching() const;
     QObject* searchModel() const;
+    QObject* renderStats() const;
     
     TextList textBoxesAtPage(int page);
 
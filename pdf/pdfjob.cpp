@@ -20,8 +20,50 @@
 
 #include <QtMath>
 #include <QUrlQuery>
+#include <QFile>
 #include <poppler-qt5.h>
 
+#include <chrono>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Regions at both ends of a file that Poppler reads first: the header and,
+// for linearized documents, the first page objects at the beginning, the
+// cross reference table and the trailer at the end.
+const qint64 headReadAhead = 256 * 1024;
+const qint64 tailReadAhead = 64 * 1024;
+
+// Asks the kernel to read these regions in the page cache ahead of Poppler.
+// The document itself is still read from its path: Poppler then reads it with
+// pread(), so the threads sharing a document don't share a file position, and
+// a file truncated meanwhile only gives short reads.
+void willNeed(const QString &fileName)
+{
+    const int fd = ::open(QFile::encodeName(fileName).constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+
+    struct stat status;
+    if (fstat(fd, &status) == 0 && status.st_size > 0) {
+        const qint64 size = status.st_size;
+        posix_fadvise(fd, 0, qMin(size, headReadAhead), POSIX_FADV_WILLNEED);
+        posix_fadvise(fd, qMax(qint64(0), size - tailReadAhead), qMin(size, tailReadAhead),
+                      POSIX_FADV_WILLNEED);
+    }
+    ::close(fd);
+}
+
+}
+
+qint64 PDFJob::timestamp()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 LoadDocumentJob::LoadDocumentJob(const QString &source)
     : PDFJob(PDFJob::LoadDocumentJob), m_source(source)
 {
@@ -29,6 +71,7 @@ LoadDocumentJob::LoadDocumentJob(const QString &source)
 
 void LoadDocumentJob::run()
 {
+    willNeed(m_source);
     m_document = Poppler::Document::load(m_source);
     if (m_document) {
         m_document->setRenderHint(Poppler::Document::Antialiasing, true);
@@ -107,7 +150,7 @@ void LinksJob::run()
 
 RenderPageJob::RenderPageJob(int index, uint width, QQuickWindow *window,
                              QRect subpart, int extraData)
-    : PDFJob(PDFJob::RenderPageJob), m_index(index), m_subpart(subpart), m_page(0), m_extraData(extraData), m_window(window), m_width(width)
+    : PDFJob(PDFJob::RenderPageJob), m_index(index), m_subpart(subpart), m_page(0), m_extraData(extraData), m_renderedAt(0), m_window(window), m_width(width)
 {
 }
 
@@ -130,8 +173,12 @@ void RenderPageJob::run()
         image = page->renderToImage(scale, scale, m_subpart.x(), m_subpart.y(),
                                     m_subpart.width(), m_subpart.height());
     }
+    m_renderedAt = timestamp();
     // Note: assuming there's exactly one handler (PDFCanvas) to catch ownership of this when PDFDocument emits a signal with this
-    m_page = m_window->createTextureFromImage(image);
+    if (m_window)
+        m_page = m_window->createTextureFromImage(image);
+    else
+        m_image = image;
     delete page;
 }
 
@@ -42,13 +42,26 @@ public:
         SearchDocumentJob,
     };
 
-    PDFJob(JobType type) : m_document(nullptr), m_type(type) { }
+    PDFJob(JobType type)
+        : m_queuedAt(0), m_startedAt(0), m_finishedAt(0)
+        , m_document(nullptr), m_type(type) { }
     virtual ~PDFJob() { }
 
     virtual void run() = 0;
 
     JobType type() const { return m_type; }
 
+    // For jobs run outside of a PDFRenderThread, like thumbnails.
+    Poppler::Document *document() const { return m_document; }
+    void setDocument(Poppler::Document *document) { m_document = document; }
+
+    // Monotonic clock, in microseconds, used to time the jobs.
+    static qint64 timestamp();
+
+    qint64 m_queuedAt;
+    qint64 m_startedAt;
+    qint64 m_finishedAt;
+
 protected:
     friend class PDFRenderThreadQueue;
     Poppler::Document *m_document;
@@ -106,6 +119,10 @@ public:
     QRect m_subpart;
     QSGTexture *m_page;
     int m_extraData;
+    // Time at which the page is rendered, before the texture upload.
+    qint64 m_renderedAt;
+    // Rendered page, only kept when there is no window to upload it to.
+    QImage m_image;
 
     int renderWidth() const { return m_width; }
     void changeRenderWidth(int width) { m_width = width; }
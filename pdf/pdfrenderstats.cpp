@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2026 Caliste Damien.
+ * Contact: Damien Caliste <dcaliste@free.fr>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 only.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "pdfrenderstats.h"
+#include "pdfjob.h"
+
+#include <QHash>
+
+Q_LOGGING_CATEGORY(lcPdfRender, "sailfishoffice.pdf.render", QtWarningMsg)
+
+struct PDFPageStats
+{
+    PDFPageStats()
+        : renderCount(0)
+        , cancelCount(0)
+        , lastQueueTime(0)
+        , lastRenderTime(0)
+        , lastUploadTime(0)
+        , totalRenderTime(0)
+    {}
+    int renderCount;
+    int cancelCount;
+    qint64 lastQueueTime;
+    qint64 lastRenderTime;
+    qint64 lastUploadTime;
+    qint64 totalRenderTime;
+};
+
+class PDFRenderStats::Private
+{
+public:
+    Private()
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        renderCount = 0;
+        cancelCount = 0;
+        totalQueueTime = 0;
+        totalRenderTime = 0;
+        totalUploadTime = 0;
+        maximumRenderTime = 0;
+        pages.clear();
+    }
+
+    qreal average(qint64 total) const
+    {
+        return renderCount > 0 ? qreal(total) / renderCount / 1000. : 0.;
+    }
+
+    // Times are accumulated in microseconds.
+    int renderCount;
+    int cancelCount;
+    qint64 totalQueueTime;
+    qint64 totalRenderTime;
+    qint64 totalUploadTime;
+    qint64 maximumRenderTime;
+    QHash<int, PDFPageStats> pages;
+};
+
+PDFRenderStats::PDFRenderStats(QObject *parent)
+    : QObject(parent), d(new Private)
+{
+}
+
+PDFRenderStats::~PDFRenderStats()
+{
+}
+
+int PDFRenderStats::renderCount() const
+{
+    return d->renderCount;
+}
+
+int PDFRenderStats::cancelCount() const
+{
+    return d->cancelCount;
+}
+
+qreal PDFRenderStats::averageQueueTime() const
+{
+    return d->average(d->totalQueueTime);
+}
+
+qreal PDFRenderStats::averageRenderTime() const
+{
+    return d->average(d->totalRenderTime);
+}
+
+qreal PDFRenderStats::averageUploadTime() const
+{
+    return d->average(d->totalUploadTime);
+}
+
+qreal PDFRenderStats::maximumRenderTime() const
+{
+    return d->maximumRenderTime / 1000.;
+}
+
+bool PDFRenderStats::tracing() const
+{
+    return lcPdfRender().isDebugEnabled();
+}
+
+void PDFRenderStats::setTracing(bool enabled)
+{
+    if (enabled != tracing()) {
+        lcPdfRender().setEnabled(QtDebugMsg, enabled);
+        emit tracingChanged();
+    }
+}
+
+void PDFRenderStats::addRenderJob(const RenderPageJob *job)
+{
+    const qint64 queueTime = job->m_startedAt - job->m_queuedAt;
+    const qint64 renderTime = job->m_renderedAt - job->m_startedAt;
+    const qint64 uploadTime = job->m_finishedAt - job->m_renderedAt;
+
+    d->renderCount += 1;
+    d->totalQueueTime += queueTime;
+    d->totalRenderTime += renderTime;
+    d->totalUploadTime += uploadTime;
+    d->maximumRenderTime = qMax(d->maximumRenderTime, renderTime);
+
+    PDFPageStats &page = d->pages[job->m_index];
+    page.renderCount += 1;
+    page.lastQueueTime = queueTime;
+    page.lastRenderTime = renderTime;
+    page.lastUploadTime = uploadTime;
+    page.totalRenderTime += renderTime;
+
+    emit statsChanged();
+}
+
+void PDFRenderStats::addCancelled(int page, int count)
+{
+    if (count <= 0)
+        return;
+
+    d->cancelCount += count;
+    if (page >= 0)
+        d->pages[page].cancelCount += count;
+
+    emit statsChanged();
+}
+
+QVariantMap PDFRenderStats::pageStats(int page) const
+{
+    const PDFPageStats stats = d->pages.value(page);
+
+    QVariantMap map;
+    map.insert(QStringLiteral("renderCount"), stats.renderCount);
+    map.insert(QStringLiteral("cancelCount"), stats.cancelCount);
+    map.insert(QStringLiteral("lastQueueTime"), stats.lastQueueTime / 1000.);
+    map.insert(QStringLiteral("lastRenderTime"), stats.lastRenderTime / 1000.);
+    map.insert(QStringLiteral("lastUploadTime"), stats.lastUploadTime / 1000.);
+    map.insert(QStringLiteral("totalRenderTime"), stats.totalRenderTime / 1000.);
+    return map;
+}
+
+void PDFRenderStats::reset()
+{
+    d->clear();
+    emit statsChanged();
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2026 Caliste Damien.
+ * Contact: Damien Caliste <dcaliste@free.fr>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 only.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PDFRENDERSTATS_H
+#define PDFRENDERSTATS_H
+
+#include <QtCore/QObject>
+#include <QtCore/QVariantMap>
+#include <QtCore/QLoggingCategory>
+
+class RenderPageJob;
+
+// Render trace, enable with
+// QT_LOGGING_RULES="sailfishoffice.pdf.render.debug=true"
+// or by setting the tracing property.
+Q_DECLARE_LOGGING_CATEGORY(lcPdfRender)
+
+class PDFRenderStats : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int renderCount READ renderCount NOTIFY statsChanged)
+    Q_PROPERTY(int cancelCount READ cancelCount NOTIFY statsChanged)
+    Q_PROPERTY(qreal averageQueueTime READ averageQueueTime NOTIFY statsChanged)
+    Q_PROPERTY(qreal averageRenderTime READ averageRenderTime NOTIFY statsChanged)
+    Q_PROPERTY(qreal averageUploadTime READ averageUploadTime NOTIFY statsChanged)
+    Q_PROPERTY(qreal maximumRenderTime READ maximumRenderTime NOTIFY statsChanged)
+    Q_PROPERTY(bool tracing READ tracing WRITE setTracing NOTIFY tracingChanged)
+
+public:
+    explicit PDFRenderStats(QObject *parent = 0);
+    ~PDFRenderStats();
+
+    // Times are given in milliseconds.
+    int renderCount() const;
+    int cancelCount() const;
+    qreal averageQueueTime() const;
+    qreal averageRenderTime() const;
+    qreal averageUploadTime() const;
+    qreal maximumRenderTime() const;
+
+    bool tracing() const;
+    void setTracing(bool enabled);
+
+    void addRenderJob(const RenderPageJob *job);
+    void addCancelled(int page, int count);
+
+    Q_INVOKABLE QVariantMap pageStats(int page) const;
+    Q_INVOKABLE void reset();
+
+Q_SIGNALS:
+    void statsChanged();
+    void tracingChanged();
+
+private:
+    class Private;
+    const QScopedPointer<Private> d;
+};
+
+#endif // PDFRENDERSTATS_H
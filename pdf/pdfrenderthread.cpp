@@ -28,6 +28,7 @@
 
 #include "pdfjob.h"
 #include "pdftocmodel.h"
+#include "pdfrenderstats.h"
 
 class PDFRenderThreadQueue;
 
@@ -229,6 +230,7 @@ public:
 protected:
     bool event(QEvent *);
     void processPendingJob();
+    void trace(const PDFJob *job) const;
 };
 
 PDFRenderThread::PDFRenderThread(QObject *parent)
@@ -368,24 +370,28 @@ void PDFRenderThread::setAutoSaveName(const QString &filename)
 void PDFRenderThread::queueJob(PDFJob *job)
 {
     QMutexLocker locker(&d->thread->mutex);
+    job->m_queuedAt = PDFJob::timestamp();
     job->moveToThread(d->thread);
     d->thread->jobQueue->enqueue(job);
     QCoreApplication::postEvent(d->thread->jobQueue, new QEvent(Event_JobPending));
 }
 
-void PDFRenderThread::cancelRenderJob(int index)
+int PDFRenderThread::cancelRenderJob(int index)
 {
     QMutexLocker locker(&d->thread->mutex);
+    int count = 0;
     for (QList<PDFJob *>::iterator it = d->thread->jobQueue->begin(); it != d->thread->jobQueue->end(); ) {
         PDFJob *j = *it;
         if (j->type() == PDFJob::RenderPageJob
                 && (index < 0 || static_cast<RenderPageJob *>(j)->m_index == index)) {
             it = d->thread->jobQueue->erase(it);
             j->deleteLater();
+            ++count;
             continue; // to skip the ++it at the end of the loop
         }
         ++it;
     }
+    return count;
 }
 
 void PDFRenderThread::prioritizeRenderJob(int index, int size, QRect subpart)
@@ -453,7 +459,10 @@ void PDFRenderThreadQueue::processPendingJob()
     }
     locker.unlock();
 
+    job->m_startedAt = PDFJob::timestamp();
     job->run();
+    job->m_finishedAt = PDFJob::timestamp();
+    trace(job);
 
     locker.relock();
 
@@ -489,6 +498,26 @@ void PDFRenderThreadQueue::processPendingJob()
     }
 }
 
+void PDFRenderThreadQueue::trace(const PDFJob *job) const
+{
+    if (!lcPdfRender().isDebugEnabled())
+        return;
+
+    const qreal queueTime = (job->m_startedAt - job->m_queuedAt) / 1000.;
+    const qreal runTime = (job->m_finishedAt - job->m_startedAt) / 1000.;
+    if (job->type() == PDFJob::RenderPageJob) {
+        const RenderPageJob *rj = static_cast<const RenderPageJob *>(job);
+        qCDebug(lcPdfRender, "page %d width %d subpart %dx%d+%d+%d: queued %.1f ms, rendered %.1f ms, uploaded %.1f ms",
+                rj->m_index, rj->renderWidth(),
+                rj->m_subpart.width(), rj->m_subpart.height(), rj->m_subpart.x(), rj->m_subpart.y(),
+                queueTime, (rj->m_renderedAt - rj->m_startedAt) / 1000.,
+                (rj->m_finishedAt - rj->m_renderedAt) / 1000.);
+    } else {
+        qCDebug(lcPdfRender, "job %d: queued %.1f ms, run %.1f ms",
+                int(job->type()), queueTime, runTime);
+    }
+}
+
 bool PDFRenderThreadQueue::event(QEvent *e)
 {
     if (e->type() == Event_JobPending) {
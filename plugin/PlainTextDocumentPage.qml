@@ -27,6 +27,15 @@ DocumentPage {
     property real fontSize: Theme.fontSizeMedium
     property real maximumWidth
     property bool wrap: true
+    // Where to start reading, as a fraction of the file. Logs open at their end
+    // and show lines as they are written.
+    property bool _log: /\.log$/i.test(documentPage.source)
+    property real startPosition: _log ? 1.0 : 0.0
+    property bool follow: _log
+    property bool _positioned
+    property bool _atEnd
+    property int _searchIndex: -1
+    property int _matchRow: -1
 
     busy: model.status === PlainTextModel.Loading && model.count === 0
     onStatusChanged: {
@@ -36,10 +45,24 @@ DocumentPage {
         }
     }
 
+    function moveToSearchMatch(index) {
+        var searchModel = model.searchModel
+        if (!searchModel || searchModel.count === 0) return
+
+        _searchIndex = (index + searchModel.count) % searchModel.count
+        _matchRow = searchModel.rowAt(_searchIndex)
+        documentView.positionViewAtIndex(_matchRow, ListView.Center)
+    }
+
     LinkHandler {
         id: linkHandler
     }
 
+    Connections {
+        target: model.searchModel
+        onCountChanged: if (documentPage._searchIndex < 0) documentPage.moveToSearchMatch(0)
+    }
+
     Flickable {
         id: horizontalFlickable
 
@@ -66,8 +89,37 @@ DocumentPage {
 
             model: PlainTextModel {
                 id: model
+
+                startPosition: documentPage.startPosition
+                follow: documentPage.follow
+
+                onSearchModelChanged: {
+                    documentPage._searchIndex = -1
+                    documentPage._matchRow = -1
+                }
+
+                onCountChanged: {
+                    // Lines before the start position are prepended as they are indexed.
+                    if (lineCount === 0) {
+                        return
+                    } else if (documentPage._positioned) {
+                        // Keep showing the last lines of a followed file as it grows.
+                        if (follow && documentPage._atEnd) {
+                            documentView.positionViewAtEnd()
+                        }
+                    } else if (startPosition >= 1.0) {
+                        documentView.positionViewAtEnd()
+                        documentPage._positioned = true
+                        documentPage._atEnd = true
+                    } else if (startRow > 0) {
+                        documentView.positionViewAtIndex(startRow, ListView.Beginning)
+                        documentPage._positioned = true
+                    }
+                }
             }
 
+            onMovementEnded: documentPage._atEnd = atYEnd
+
             header: DocumentHeader {
                 x: horizontalFlickable.contentX
                 page: documentPage
@@ -76,6 +128,9 @@ DocumentPage {
 
             delegate: Rectangle {
                 width: horizontalFlickable.contentWidth
+                color: index === documentPage._matchRow
+                       ? Theme.rgba(Theme.highlightBackgroundColor, Theme.highlightBackgroundOpacity)
+                       : "white"
                 height: line.implicitHeight
                         + (index == 0 ? Theme.paddingLarge : 0)
                         + (index == documentView.count - 1 ? Theme.paddingLarge : 0)
@@ -90,7 +145,7 @@ DocumentPage {
                     linkColor: Theme.highlightColor
                     font.pixelSize: Math.round(documentPage.fontSize)
                     text: lineText
-                    textFormat: Text.StyledText
+                    textFormat: richText ? Text.StyledText : Text.PlainText
 
                     onImplicitWidthChanged: {
                         if (implicitWidth > documentPage.maximumWidth) {
@@ -130,6 +185,23 @@ DocumentPage {
         enabled: !documentPage.busy
         opacity: enabled ? 1.0 : 0.0
         Behavior on opacity { FadeAnimator { duration: 400 }}
+        autoShowHide: !search.active
+
+        SearchBarItem {
+            id: search
+            width: Theme.itemSizeSmall
+            expandedWidth: documentPage.width
+            height: parent.height
+
+            searching: model.searching
+            searchProgress: model.searchModel ? model.searchModel.fraction : 0.
+            matchCount: model.searchModel ? model.searchModel.count : -1
+
+            onRequestSearch: model.search(text)
+            onRequestPreviousMatch: documentPage.moveToSearchMatch(documentPage._searchIndex - 1)
+            onRequestNextMatch: documentPage.moveToSearchMatch(documentPage._searchIndex + 1)
+            onRequestCancel: model.cancelSearch(!model.searching)
+        }
 
         DeleteButton {
             page: documentPage
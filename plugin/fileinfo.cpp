@@ -17,17 +17,62 @@
  */
 
 #include "fileinfo.h"
+#include "mimetypecache.h"
 
-#include <QtCore/QMimeType>
+#include <QtCore/QAtomicInt>
 #include <QtCore/QFileInfo>
-#include <QtCore/QMimeDatabase>
 #include <QtCore/QDir>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
+
+namespace {
+
+// Reads the details of a file on a thread of the pool, and hands them to the FileInfo.
+class FileResolver : public QRunnable
+{
+public:
+    FileResolver(QObject *receiver, const QAtomicInt *generation, const QString &path)
+        : m_receiver(receiver)
+        , m_generation(generation)
+        , m_id(generation->load())
+        , m_path(path)
+    {
+    }
+
+    void run() override
+    {
+        if (m_generation->load() != m_id) {
+            return;
+        }
+
+        const MimeTypeCache::Type type = MimeTypeCache::mimeTypeForFile(QFileInfo(m_path));
+
+        if (m_generation->load() == m_id) {
+            QMetaObject::invokeMethod(m_receiver, "setResolved", Qt::QueuedConnection,
+                                      Q_ARG(int, m_id), Q_ARG(qint64, type.size), Q_ARG(QDateTime, type.modified),
+                                      Q_ARG(QString, type.mimeType.name()),
+                                      Q_ARG(QString, type.mimeType.comment()));
+        }
+    }
+
+private:
+    QObject * const m_receiver;
+    const QAtomicInt * const m_generation;
+    const int m_id;
+    const QString m_path;
+};
+
+}
 
 class FileInfo::Private
 {
 public:
     Private()
-    { }
+        : fileSize(0)
+        , ready(false)
+    {
+        pool.setMaxThreadCount(1);
+    }
 
     void resolvePath();
 
@@ -35,8 +80,14 @@ public:
 
     QUrl path;
 
-    QFileInfo fileInfo;
-    QMimeType mimeType;
+    qint64 fileSize;
+    QDateTime modifiedDate;
+    QString mimeType;
+    QString mimeTypeComment;
+    bool ready;
+
+    QThreadPool pool;
+    QAtomicInt generation;
 };
 
 FileInfo::FileInfo(QObject *parent)
@@ -46,6 +97,9 @@ FileInfo::FileInfo(QObject *parent)
 
 FileInfo::~FileInfo()
 {
+    d->generation.ref();
+    d->pool.waitForDone();
+
     delete d;
 }
 
@@ -59,15 +113,33 @@ void FileInfo::setSource(const QString &source)
     if (source != d->source) {
         d->source = source;
 
+        const bool wasReady = d->ready;
+        d->generation.ref();
+        d->fileSize = 0;
+        d->modifiedDate = QDateTime();
+        d->mimeType.clear();
+        d->mimeTypeComment.clear();
+        d->ready = false;
+
         d->resolvePath();
+        const QString localPath = d->path.toLocalFile();
+        if (!localPath.isEmpty()) {
+            d->pool.start(new FileResolver(this, &d->generation, localPath));
+        } else if (!source.isEmpty()) {
+            // Only local files can be looked up, the details stay empty.
+            d->ready = true;
+        }
 
         emit sourceChanged();
+        if (wasReady || d->ready) {
+            emit readyChanged();
+        }
     }
 }
 
 QString FileInfo::fileName() const
 {
-    return d->fileInfo.fileName();
+    return QFileInfo(d->path.toLocalFile()).fileName();
 }
 
 QUrl FileInfo::fullPath() const
@@ -77,22 +149,43 @@ QUrl FileInfo::fullPath() const
 
 qint64 FileInfo::fileSize() const
 {
-    return d->fileInfo.size();
+    return d->fileSize;
 }
 
 QString FileInfo::mimeType() const
 {
-    return d->mimeType.name();
+    return d->mimeType;
 }
 
 QString FileInfo::mimeTypeComment() const
 {
-    return d->mimeType.comment();
+    return d->mimeTypeComment;
 }
 
 QDateTime FileInfo::modifiedDate() const
 {
-    return d->fileInfo.lastModified();
+    return d->modifiedDate;
+}
+
+bool FileInfo::isReady() const
+{
+    return d->ready;
+}
+
+void FileInfo::setResolved(int generation, qint64 size, const QDateTime &modified,
+                           const QString &mimeType, const QString &mimeTypeComment)
+{
+    if (generation != d->generation.load()) {
+        return;
+    }
+
+    d->fileSize = size;
+    d->modifiedDate = modified;
+    d->mimeType = mimeType;
+    d->mimeTypeComment = mimeTypeComment;
+    d->ready = true;
+
+    emit readyChanged();
 }
 
 void FileInfo::Private::resolvePath()
@@ -103,8 +196,4 @@ void FileInfo::Private::resolvePath()
 
     if (path.isRelative())
         path = QUrl::fromLocalFile(QDir::current().absoluteFilePath(source));
-
-    fileInfo = QFileInfo(path.toLocalFile());
-    QMimeDatabase db;
-    mimeType = db.mimeTypeForFile(fileInfo);
 }
@@ -23,16 +23,24 @@
 #include <QtCore/QUrl>
 #include <QtCore/QDateTime>
 
+// Details on a local file.
+//
+// The file name and path are known as soon as the source is set. Its size,
+// modification date and mime type are looked up on a thread, and are valid once
+// ready is set. A source which isn't a local file is ready at once, without
+// details. Mime types are kept for the next lookups of a file that was not
+// modified since.
 class FileInfo : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(QString source READ source WRITE setSource NOTIFY sourceChanged)
     Q_PROPERTY(QString fileName READ fileName NOTIFY sourceChanged)
     Q_PROPERTY(QUrl fullPath READ fullPath NOTIFY sourceChanged)
-    Q_PROPERTY(qint64 fileSize READ fileSize NOTIFY sourceChanged)
-    Q_PROPERTY(QString mimeType READ mimeType NOTIFY sourceChanged)
-    Q_PROPERTY(QString mimeTypeComment READ mimeTypeComment NOTIFY sourceChanged)
-    Q_PROPERTY(QDateTime modifiedDate READ modifiedDate NOTIFY sourceChanged)
+    Q_PROPERTY(qint64 fileSize READ fileSize NOTIFY readyChanged)
+    Q_PROPERTY(QString mimeType READ mimeType NOTIFY readyChanged)
+    Q_PROPERTY(QString mimeTypeComment READ mimeTypeComment NOTIFY readyChanged)
+    Q_PROPERTY(QDateTime modifiedDate READ modifiedDate NOTIFY readyChanged)
+    Q_PROPERTY(bool ready READ isReady NOTIFY readyChanged)
 
 public:
     explicit FileInfo(QObject *parent = 0);
@@ -45,12 +53,18 @@ public:
     QString mimeType() const;
     QString mimeTypeComment() const;
     QDateTime modifiedDate() const;
+    bool isReady() const;
 
 public Q_SLOTS:
     void setSource(const QString &source);
 
 Q_SIGNALS:
     void sourceChanged();
+    void readyChanged();
+
+private Q_SLOTS:
+    void setResolved(int generation, qint64 size, const QDateTime &modified,
+                     const QString &mimeType, const QString &mimeTypeComment);
 
 private:
     class Private;
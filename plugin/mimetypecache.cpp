@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2026 Caliste Damien.
+ * Contact: Damien Caliste <dcaliste@free.fr>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 only.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "mimetypecache.h"
+
+#include <QtCore/QFileInfo>
+#include <QtCore/QHash>
+#include <QtCore/QMimeDatabase>
+#include <QtCore/QMutex>
+
+namespace {
+
+struct Cache
+{
+    QMimeDatabase database;
+    QMutex mutex;
+    QHash<QString, MimeTypeCache::Type> types;
+};
+
+Q_GLOBAL_STATIC(Cache, cache)
+
+}
+
+MimeTypeCache::Type MimeTypeCache::mimeTypeForFile(const QFileInfo &info)
+{
+    const QString path = info.absoluteFilePath();
+    Type type;
+    type.modified = info.lastModified();
+    type.size = info.size();
+
+    {
+        QMutexLocker locker(&cache->mutex);
+        const auto it = cache->types.constFind(path);
+        if (it != cache->types.constEnd() && it->modified == type.modified && it->size == type.size) {
+            return *it;
+        }
+    }
+
+    // The database is thread safe.
+    type.mimeType = cache->database.mimeTypeForFile(info);
+    if (info.exists()) {
+        QMutexLocker locker(&cache->mutex);
+        cache->types.insert(path, type);
+    }
+    return type;
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2026 Caliste Damien.
+ * Contact: Damien Caliste <dcaliste@free.fr>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 only.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef MIMETYPECACHE_H
+#define MIMETYPECACHE_H
+
+#include <QtCore/QDateTime>
+#include <QtCore/QMimeType>
+
+class QFileInfo;
+
+// The mime types of the local files already looked up, with the mime database
+// used to look them up. Both are shared by the whole module, from any thread.
+class MimeTypeCache
+{
+public:
+    struct Type
+    {
+        QDateTime modified;
+        qint64 size;
+        QMimeType mimeType;
+    };
+
+    // The type of a file, sniffing its content only when the name is not enough.
+    // The type is looked up again when the file is modified.
+    static Type mimeTypeForFile(const QFileInfo &info);
+};
+
+#endif // MIMETYPECACHE_H
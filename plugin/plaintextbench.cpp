@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2026 Caliste Damien.
+ * Contact: Damien Caliste <dcaliste@free.fr>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 only.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+// Benchmark of PlainTextModel. It loads generated and given text files
+// and prints the measures as JSON on the standard output.
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include <sys/resource.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "plaintextmodel.h"
+
+namespace {
+
+const int randomAccessCount = 1000;
+
+// Peak resident set size in kilobytes.
+qint64 peakRss()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// Current resident set size in kilobytes.
+qint64 currentRss()
+{
+    QFile statm(QStringLiteral("/proc/self/statm"));
+    if (!statm.open(QIODevice::ReadOnly))
+        return 0;
+    const QList<QByteArray> values = statm.readAll().split(' ');
+    return values.count() > 1 ? values.at(1).toLongLong() * sysconf(_SC_PAGESIZE) / 1024 : 0;
+}
+
+qint64 parseSize(QString size)
+{
+    qint64 unit = 1;
+    if (size.endsWith(QLatin1Char('K'), Qt::CaseInsensitive))
+        unit = Q_INT64_C(1024);
+    else if (size.endsWith(QLatin1Char('M'), Qt::CaseInsensitive))
+        unit = Q_INT64_C(1024) * 1024;
+    else if (size.endsWith(QLatin1Char('G'), Qt::CaseInsensitive))
+        unit = Q_INT64_C(1024) * 1024 * 1024;
+    if (unit > 1)
+        size.chop(1);
+    return size.toLongLong() * unit;
+}
+
+QByteArray lineOfKind(const QString &kind, int index)
+{
+    if (kind == QLatin1String("long")) {
+        return QByteArray(64 * 1024, 'x') + ' ' + QByteArray::number(index) + '\n';
+    } else if (kind == QLatin1String("utf8")) {
+        return QByteArray("Ελληνικά κείμενα – 日本語のテキスト – ÅÄÖ åäö ") + QByteArray::number(index) + '\n';
+    } else if (index % 10 == 0) {
+        return QByteArray("line ") + QByteArray::number(index) + " see https://sailfishos.org/\n";
+    } else {
+        return QByteArray("line ") + QByteArray::number(index) + " lorem ipsum\n";
+    }
+}
+
+bool generate(const QString &fileName, const QString &kind, qint64 size)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QByteArray block;
+    qint64 written = 0;
+    for (int index = 0; written + block.size() < size; ++index) {
+        block += lineOfKind(kind, index);
+        if (block.size() >= 1024 * 1024) {
+            if (file.write(block) != block.size())
+                return false;
+            written += block.size();
+            block.clear();
+        }
+    }
+    block.truncate(size - written);
+    return file.write(block) == block.size();
+}
+
+QJsonObject benchmark(const QString &fileName, const QString &kind)
+{
+    QJsonObject result;
+    result.insert(QStringLiteral("file"), fileName);
+    result.insert(QStringLiteral("kind"), kind);
+    result.insert(QStringLiteral("size"), QFileInfo(fileName).size());
+
+    const qint64 rssBefore = currentRss();
+
+    PlainTextModel model;
+    QEventLoop loop;
+    QElapsedTimer timer;
+    qint64 firstRows = -1;
+
+    QObject::connect(&model, &PlainTextModel::countChanged, &loop, [&]() {
+        if (firstRows < 0 && model.rowCount() > 0)
+            firstRows = timer.nsecsElapsed();
+    });
+    QObject::connect(&model, &PlainTextModel::statusChanged, &loop, [&]() {
+        if (model.status() != PlainTextModel::Loading)
+            loop.quit();
+    });
+
+    timer.start();
+    model.setSource(QUrl::fromLocalFile(fileName));
+    if (model.status() == PlainTextModel::Loading)
+        loop.exec();
+    const qint64 indexTime = timer.nsecsElapsed();
+    if (firstRows < 0 && model.rowCount() > 0)
+        firstRows = indexTime;
+
+    if (model.status() != PlainTextModel::Ready) {
+        result.insert(QStringLiteral("error"), QStringLiteral("load failure"));
+        return result;
+    }
+
+    const int rows = model.rowCount();
+    result.insert(QStringLiteral("rows"), rows);
+    result.insert(QStringLiteral("firstRowsTime"), firstRows / 1000000.);
+    result.insert(QStringLiteral("indexTime"), indexTime / 1000000.);
+
+    if (rows > 0) {
+        srand(rows);
+        timer.restart();
+        for (int i = 0; i < randomAccessCount; ++i)
+            model.textAt(rand() % rows);
+        result.insert(QStringLiteral("randomAccessTime"),
+                      timer.nsecsElapsed() / 1000. / randomAccessCount);
+    }
+
+    result.insert(QStringLiteral("indexMemory"), qint64(model.indexMemoryUsage()));
+    result.insert(QStringLiteral("rss"), currentRss() - rssBefore);
+    result.insert(QStringLiteral("peakRss"), peakRss());
+
+    return result;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication app(argc, argv);
+    app.setApplicationName(QStringLiteral("plaintext-bench"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Benchmark the plain text model of Sailfish Office."));
+    parser.addHelpOption();
+    QCommandLineOption sizesOption(QStringLiteral("sizes"),
+                                   QStringLiteral("Comma separated sizes of the generated files, with K, M or G units. "
+                                                  "The model does not load files of 2G and more, such sizes are skipped."),
+                                   QStringLiteral("sizes"), QStringLiteral("1K,1M,64M"));
+    QCommandLineOption kindsOption(QStringLiteral("kinds"),
+                                   QStringLiteral("Comma separated kinds of generated files: short, long, utf8."),
+                                   QStringLiteral("kinds"), QStringLiteral("short,long,utf8"));
+    parser.addOption(sizesOption);
+    parser.addOption(kindsOption);
+    parser.addPositionalArgument(QStringLiteral("files"), QStringLiteral("Additional text files to load."));
+    parser.process(app);
+
+    QTemporaryDir directory;
+    if (!directory.isValid()) {
+        fprintf(stderr, "Cannot create a temporary directory.\n");
+        return 1;
+    }
+
+    QJsonObject settings;
+    settings.insert(QStringLiteral("maximumSynchronousSize"), qint64(PlainTextModel::maximumSynchronousSize));
+    settings.insert(QStringLiteral("maximumCost"), qint64(PlainTextModel::maximumCost));
+    settings.insert(QStringLiteral("maximumFileSize"), qint64(PlainTextModel::maximumFileSize));
+
+    QJsonArray results;
+    for (const QString &kind : parser.value(kindsOption).split(QLatin1Char(','), QString::SkipEmptyParts)) {
+        for (const QString &size : parser.value(sizesOption).split(QLatin1Char(','), QString::SkipEmptyParts)) {
+            const QString fileName = directory.path() + QStringLiteral("/%1-%2.txt").arg(kind, size);
+            if (parseSize(size) > PlainTextModel::maximumFileSize) {
+                QJsonObject result;
+                result.insert(QStringLiteral("kind"), kind);
+                result.insert(QStringLiteral("size"), parseSize(size));
+                result.insert(QStringLiteral("error"), QStringLiteral("larger than maximumFileSize"));
+                results.append(result);
+                continue;
+            }
+            if (!generate(fileName, kind, parseSize(size))) {
+                fprintf(stderr, "Cannot write %s.\n", qPrintable(fileName));
+                return 1;
+            }
+            results.append(benchmark(fileName, kind));
+            QFile::remove(fileName);
+        }
+    }
+    for (const QString &fileName : parser.positionalArguments())
+        results.append(benchmark(fileName, QStringLiteral("file")));
+
+    QJsonObject output;
+    output.insert(QStringLiteral("settings"), settings);
+    output.insert(QStringLiteral("results"), results);
+    fputs(QJsonDocument(output).toJson().constData(), stdout);
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2026 Caliste Damien.
+ * Contact: Damien Caliste <dcaliste@free.fr>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 only.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "plaintextindex.h"
+
+PlainTextIndex::PlainTextIndex(int lineFeedSize)
+    : m_lineFeedSize(lineFeedSize)
+{
+}
+
+void PlainTextIndex::append(qint64 offset, qint64 length, bool continuation)
+{
+    const int row = count();
+
+    if ((row & BlockMask) == 0) {
+        m_blocks.push_back({ offset, -1, 0 });
+    }
+
+    Block &block = m_blocks.back();
+    if (continuation) {
+        block.continuations |= quint64(1) << (row & BlockMask);
+    }
+    const qint64 relativeOffset = offset - block.offset;
+
+    if (block.wide < 0 && relativeOffset > 0xffff) {
+        // Switch the block to absolute offsets.
+        block.wide = int(m_wideOffsets.size() >> BlockShift);
+        m_wideOffsets.resize(m_wideOffsets.size() + BlockSize);
+        for (int i = row & ~BlockMask; i < row; ++i) {
+            m_wideOffsets[(block.wide << BlockShift) + (i & BlockMask)] = block.offset + m_offsets[i];
+        }
+    }
+
+    if (block.wide >= 0) {
+        m_wideOffsets[(block.wide << BlockShift) + (row & BlockMask)] = offset;
+        m_offsets.push_back(0);
+    } else {
+        m_offsets.push_back(quint16(relativeOffset));
+    }
+
+    m_end = offset + length;
+}
+
+void PlainTextIndex::removeLast()
+{
+    const int row = count() - 1;
+    const qint64 offset = this->offset(row);
+    const bool continuation = isContinuation(row);
+
+    m_blocks.back().continuations &= ~(quint64(1) << (row & BlockMask));
+    m_offsets.pop_back();
+    if ((row & BlockMask) == 0) {
+        // Blocks only become wide while they are last, so this one owns the last wide offsets.
+        if (m_blocks.back().wide >= 0) {
+            m_wideOffsets.resize(m_wideOffsets.size() - BlockSize);
+        }
+        m_blocks.pop_back();
+    }
+
+    m_end = row > 0 ? offset - (continuation ? 0 : m_lineFeedSize) : 0;
+}
+
+void PlainTextIndex::clear()
+{
+    m_blocks.clear();
+    m_offsets.clear();
+    m_wideOffsets.clear();
+    m_end = 0;
+}
+
+size_t PlainTextIndex::memoryUsage() const
+{
+    return m_blocks.capacity() * sizeof(Block)
+            + m_offsets.capacity() * sizeof(quint16)
+            + m_wideOffsets.capacity() * sizeof(qint64);
+}
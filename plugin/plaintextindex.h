@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2026 Caliste Damien.
+ * Contact: Damien Caliste <dcaliste@free.fr>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 only.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PLAINTEXTINDEX_H
+#define PLAINTEXTINDEX_H
+
+#include <QtGlobal>
+
+#include <vector>
+
+// Byte offsets of the lines of a text file.
+//
+// Lines are grouped in blocks of 64 rows. A block stores the absolute offset
+// of its first line and every line stores its offset relative to that on 16
+// bits. With 24 bytes per block, this is 2.375 bytes per line instead of two
+// 64 bit integers. Blocks spanning more than 64 KB keep absolute offsets
+// for their lines instead. Lengths are deduced from the offset of the
+// following line.
+//
+// Long lines may be split into several rows. The rows following the first
+// one are continuations: they start right where the previous row ends,
+// without a line feed in between.
+class PlainTextIndex
+{
+public:
+    explicit PlainTextIndex(int lineFeedSize = 1);
+
+    int count() const { return int(m_offsets.size()); }
+    bool isEmpty() const { return m_offsets.empty(); }
+
+    inline qint64 offset(int row) const;
+    inline qint64 length(int row) const;
+    inline bool isContinuation(int row) const;
+
+    // Rows must be appended in file order, each one starting after the line
+    // feed ending the previous one, or right after it for a continuation.
+    void append(qint64 offset, qint64 length, bool continuation = false);
+    void removeLast();
+    void clear();
+
+    // Approximate size of the index in bytes.
+    size_t memoryUsage() const;
+
+private:
+    enum {
+        BlockShift = 6,
+        BlockSize = 1 << BlockShift,
+        BlockMask = BlockSize - 1
+    };
+
+    struct Block
+    {
+        qint64 offset;
+        int wide;   // Index of the absolute offsets of a wide block, or -1.
+        quint64 continuations;  // One bit per continuation row.
+    };
+
+    std::vector<Block> m_blocks;
+    std::vector<quint16> m_offsets;
+    std::vector<qint64> m_wideOffsets;
+    qint64 m_end = 0;
+    int m_lineFeedSize;
+};
+
+qint64 PlainTextIndex::offset(int row) const
+{
+    const Block &block = m_blocks[row >> BlockShift];
+    return block.wide >= 0
+            ? m_wideOffsets[(block.wide << BlockShift) + (row & BlockMask)]
+            : block.offset + m_offsets[row];
+}
+
+qint64 PlainTextIndex::length(int row) const
+{
+    return row + 1 < count()
+            ? offset(row + 1) - offset(row) - (isContinuation(row + 1) ? 0 : m_lineFeedSize)
+            : m_end - offset(row);
+}
+
+bool PlainTextIndex::isContinuation(int row) const
+{
+    return (m_blocks[row >> BlockShift].continuations >> (row & BlockMask)) & 1;
+}
+
+#endif // PLAINTEXTINDEX_H
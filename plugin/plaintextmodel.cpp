@@ -17,34 +17,263 @@
  */
 
 #include "plaintextmodel.h"
+#include "plaintextsearchmodel.h"
 
 #include <QCoreApplication>
+#include <QDebug>
 #include <QEvent>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
 #include <QQmlInfo>
+#include <QQueue>
+#include <QSemaphore>
+#include <QTextCodec>
 #include <QThread>
+#include <QThreadPool>
 #include <silicatheme.h>
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <sys/stat.h>
+
+namespace {
+
+// Bytes read at once while indexing, a multiple of every code unit size.
+const qint64 blockSize = 64 * 1024;
+
+// How far back from the maximum row length a blank is looked for to split a long line.
+const qint64 splitSearchLength = 128;
+
+inline char foldCase(char c)
+{
+    return c >= 'A' && c <= 'Z' ? c | 0x20 : c;
+}
+
+// Appends the offsets of the occurrences of a needle in bytes starting before limit. Candidates
+// are found with memchr(), which is vectorized by the C library. With ignoreCase, the needle
+// is in lower case and ASCII letters match regardless of their case.
+void findMatches(
+        const QByteArray &needle, bool ignoreCase, int unitSize, qint64 unitStart,
+        const char *bytes, qint64 count, qint64 base, qint64 limit, std::vector<qint64> *offsets)
+{
+    const qint64 length = needle.size();
+    const char * const last = bytes + count - length;
+    if (length == 0 || last < bytes) {
+        return;
+    }
+
+    const char lower = needle.at(0);
+    const char upper = ignoreCase && lower >= 'a' && lower <= 'z' ? lower & ~0x20 : lower;
+
+    const char *nextLower = static_cast<const char *>(std::memchr(bytes, lower, last - bytes + 1));
+    const char *nextUpper = upper != lower
+            ? static_cast<const char *>(std::memchr(bytes, upper, last - bytes + 1))
+            : nullptr;
+
+    while (nextLower || nextUpper) {
+        const char * const candidate = !nextUpper || (nextLower && nextLower < nextUpper)
+                ? nextLower
+                : nextUpper;
+        const qint64 offset = base + (candidate - bytes);
+        if (offset >= limit) {
+            break;
+        }
+
+        bool match = (offset - unitStart) % unitSize == 0;
+        if (match && ignoreCase) {
+            for (qint64 i = 1; match && i < length; ++i) {
+                match = foldCase(candidate[i]) == needle.at(i);
+            }
+        } else if (match) {
+            match = std::memcmp(candidate + 1, needle.constData() + 1, length - 1) == 0;
+        }
+        if (match) {
+            offsets->push_back(offset);
+        }
+
+        if (candidate == nextLower) {
+            nextLower = static_cast<const char *>(std::memchr(candidate + 1, lower, last - candidate));
+        } else {
+            nextUpper = static_cast<const char *>(std::memchr(candidate + 1, upper, last - candidate));
+        }
+    }
+}
+
+// Bytes of each sample checked for UTF-8.
+const qint64 sampleSize = 16 * 1024;
+
+bool isAscii(const char *begin, const char *end)
+{
+    const char *c = begin;
+    for (; end - c >= qint64(sizeof(quint64)); c += sizeof(quint64)) {
+        quint64 word;
+        std::memcpy(&word, c, sizeof(word));
+        if (word & Q_UINT64_C(0x8080808080808080)) {
+            return false;
+        }
+    }
+    for (; c != end; ++c) {
+        if (*c & 0x80) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Tells whether bytes are valid UTF-8. Sequences cut at the edges of a sample are ignored,
+// unless these edges are the start or the end of the file.
+bool isUtf8(const char *begin, const char *end, bool atStart, bool atEnd)
+{
+    const uchar *c = reinterpret_cast<const uchar *>(begin);
+    const uchar * const last = reinterpret_cast<const uchar *>(end);
+
+    if (!atStart) {
+        for (int i = 0; i < 3 && c != last && (*c & 0xc0) == 0x80; ++i) {
+            ++c;
+        }
+    }
+
+    while (c != last) {
+        if (*c < 0x80) {
+            ++c;
+            continue;
+        }
+
+        int count;
+        uchar minimum = 0x80;
+        uchar maximum = 0xbf;
+        if (*c >= 0xc2 && *c <= 0xdf) {
+            count = 1;
+        } else if (*c >= 0xe0 && *c <= 0xef) {
+            count = 2;
+            minimum = *c == 0xe0 ? 0xa0 : 0x80;     // Overlong encodings.
+            maximum = *c == 0xed ? 0x9f : 0xbf;     // Surrogates.
+        } else if (*c >= 0xf0 && *c <= 0xf4) {
+            count = 3;
+            minimum = *c == 0xf0 ? 0x90 : 0x80;     // Overlong encodings.
+            maximum = *c == 0xf4 ? 0x8f : 0xbf;     // Above U+10FFFF.
+        } else {
+            return false;
+        }
+
+        if (last - c <= count) {
+            if (!atEnd) {
+                // A sequence cut by the end of the sample.
+                for (++c; c != last; ++c, minimum = 0x80, maximum = 0xbf) {
+                    if (*c < minimum || *c > maximum) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            return false;
+        }
+
+        ++c;
+        for (int i = 0; i < count; ++i, ++c, minimum = 0x80, maximum = 0xbf) {
+            if (*c < minimum || *c > maximum) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Tells whether a line may contain a URL, an email address or a phone number, so the costly
+// link encoding can be skipped for the others. Char is a byte of an ASCII compatible encoding
+// or a UTF-16 code unit.
+template <typename Char>
+bool mayContainLinks(const Char *begin, const Char *end)
+{
+    int digits = 0;
+    for (const Char *c = begin; c != end; ++c) {
+        switch (*c) {
+        case '@':
+            return true;
+        case ':':
+            if (end - c >= 3 && c[1] == '/' && c[2] == '/') {
+                return true;
+            }
+            digits = 0;
+            break;
+        case '.':
+            if (c - begin >= 3 && (c[-1] | 0x20) == 'w' && (c[-2] | 0x20) == 'w' && (c[-3] | 0x20) == 'w') {
+                return true;
+            }
+            break;
+        case ' ':
+        case '-':
+        case '+':
+        case '(':
+        case ')':
+        case '/':
+            // Separators between the digits of a phone number.
+            break;
+        default:
+            if (*c >= '0' && *c <= '9') {
+                if (++digits >= 7) {
+                    return true;
+                }
+            } else {
+                digits = 0;
+            }
+            break;
+        }
+    }
+    return false;
+}
+
+}
+
 class PlainTextModel::FileData : public QSharedData
 {
 public:
-    FileData(PlainTextModel *model)
-        : fileName(model->m_file.fileName())
+    FileData(const QString &fileName, PlainTextModel *model)
+        : fileName(fileName)
+        , file(fileName)
         , model(model)
     {
     }
 
-    QString fileName;
+    // Maps the whole file, so lines can be indexed and decoded straight from
+    // memory. The mapping is released with the file, once the model and the
+    // reader are both done with it. Mapping again extends it to a grown file.
+    // A followed file is never mapped, only its size is updated: it may be
+    // truncated in place, and reading a mapping past the end of its file raises
+    // SIGBUS. It is read with QFile like a file which couldn't be mapped.
+    inline void map();
+
+    const QString fileName;
+    QFile file;
+    Encoding encoding;
+    bool followed = false;
+    quint64 inode = 0;
+    const char *data = nullptr;
+    qint64 size = 0;
     PlainTextModel *model = nullptr;
+    // Changed to stop the current search.
+    QAtomicInt searchId;
+    // Searchers still reading the mapping, which isn't remapped until they are done.
+    QAtomicInt searchers;
 };
 
 class PlainTextModel::Reader : public QThread
 {
 public:
-    inline Reader(const QExplicitlySharedDataPointer<PlainTextModel::FileData> &fileData);
+    inline Reader(
+            const QExplicitlySharedDataPointer<PlainTextModel::FileData> &fileData,
+            qreal startPosition);
 
     inline void run() override;
 
+    // Posts the lines of a completed indexer and deletes it.
+    inline void publish(Indexer *indexer, bool prepend, bool atEnd);
+
     QExplicitlySharedDataPointer<PlainTextModel::FileData> m_fileData;
+    const qreal m_startPosition;
 };
 
 class PlainTextModel::ReaderEvent : public QEvent
@@ -54,11 +283,61 @@ public:
     inline ~ReaderEvent();
 
     const QExplicitlySharedDataPointer<PlainTextModel::FileData> fileData;
-    std::vector<PlainTextModel::Line> lines;
-    std::vector<QString> text;
+    PlainTextIndex lines;
+    qint64 start = 0;
+    qint64 end = 0;
+    bool prepend = false;
     bool atEnd = false;
 };
 
+// Finds the byte offsets of a needle in the file.
+class PlainTextModel::Searcher : public QThread
+{
+public:
+    inline Searcher(
+            const QExplicitlySharedDataPointer<PlainTextModel::FileData> &fileData,
+            const QByteArray &needle, bool ignoreCase);
+
+    inline void run() override;
+    inline void search();
+
+    const QExplicitlySharedDataPointer<PlainTextModel::FileData> m_fileData;
+    const QByteArray m_needle;
+    const int m_searchId;
+    const bool m_ignoreCase;
+};
+
+class PlainTextModel::SearchEvent : public QEvent
+{
+public:
+    inline SearchEvent(const QExplicitlySharedDataPointer<PlainTextModel::FileData> &fileData, int searchId);
+    inline ~SearchEvent();
+
+    const QExplicitlySharedDataPointer<PlainTextModel::FileData> fileData;
+    const int searchId;
+    std::vector<qint64> offsets;
+    float fraction = 0;
+    bool atEnd = false;
+};
+
+// Indexes a range of a mapped file which starts and ends on line boundaries.
+class PlainTextModel::Indexer : public QRunnable
+{
+public:
+    inline Indexer(
+            const QExplicitlySharedDataPointer<PlainTextModel::FileData> &fileData,
+            qint64 start, qint64 end, bool continued = false);
+
+    inline void run() override;
+
+    const QExplicitlySharedDataPointer<PlainTextModel::FileData> m_fileData;
+    PlainTextIndex m_lines;
+    QSemaphore m_done;
+    const qint64 m_start;
+    const qint64 m_end;
+    const bool m_continued;
+};
+
 PlainTextModel::PlainTextModel(QObject *parent)
     : QAbstractItemModel(parent)
 {
@@ -68,7 +347,9 @@ PlainTextModel::~PlainTextModel()
 {
     if (m_fileData) {
         m_fileData->model = nullptr;
+        m_fileData->searchId.ref();
     }
+    delete m_searchModel;
 }
 
 QUrl PlainTextModel::source() const
@@ -79,84 +360,182 @@ QUrl PlainTextModel::source() const
 void PlainTextModel::setSource(const QUrl &source)
 {
     if (m_source != source) {
-        const Status previousStatus = m_status;
-        const size_t previousCount = m_lines.size();
-
         m_source = source;
 
-        if (!m_lines.empty()) {
-            beginRemoveRows(QModelIndex(), 0, m_lines.size() - 1);
-            m_cost = 0;
-            m_lines.clear();
-            endRemoveRows();
-        }
+        load();
+        watch();
+
+        emit sourceChanged();
+    }
+}
 
-        m_textStream.setDevice(nullptr);
-        m_file.close();
+void PlainTextModel::load()
+{
+    const Status previousStatus = m_status;
+    const int previousCount = m_rowCount;
+    const QString previousEncoding = encoding();
 
-        if (m_fileData) {
-            m_fileData->model = nullptr;
-            m_fileData.reset();
-        }
+    cancelSearch();
 
-        if (m_source.isEmpty()) {
-            m_status = Null;
-        } else if (!m_source.isLocalFile()) {
-            qmlInfo(this) << m_source << " is not a local file";
+    if (m_rowCount > 0) {
+        beginRemoveRows(QModelIndex(), 0, m_rowCount - 1);
+        m_segments.clear();
+        m_rowCount = 0;
+        m_textCache.clear();
+        endRemoveRows();
+    }
+    m_startRow = 0;
+    m_indexStart = 0;
+    m_indexEnd = 0;
+
+    if (m_fileData) {
+        m_fileData->model = nullptr;
+        m_fileData.reset();
+    }
+
+    if (m_source.isEmpty()) {
+        m_status = Null;
+    } else if (!m_source.isLocalFile()) {
+        qmlInfo(this) << m_source << " is not a local file";
+        m_status = Error;
+    } else {
+        m_fileData = new FileData(m_source.toLocalFile(), this);
+        m_fileData->followed = m_follow;
+        QFile &file = m_fileData->file;
+
+        if (file.size() == 0) {
+            m_status = Ready;
+        } else if (file.size() < 0 || file.size() > maximumFileSize) {
+            qmlInfo(this) << "File is too large " << m_source << ": " << file.errorString();
+            m_status = Error;
+        } else if (!file.open(QIODevice::ReadOnly)) {
+            qmlInfo(this) << "Can't open " << m_source << ": " << file.errorString();
             m_status = Error;
         } else {
-            m_file.setFileName(m_source.toLocalFile());
+            struct stat status;
+            if (::fstat(file.handle(), &status) == 0) {
+                m_fileData->inode = status.st_ino;
+            }
 
-            if (m_file.size() == 0) {
-                m_status = Ready;
-            } else if (m_file.size() < 0 || m_file.size() > maximumFileSize) {
-                qmlInfo(this) << "File is too large " << m_source << ": " << m_file.errorString();
-                m_status = Error;
-            } else if (!m_file.open(QIODevice::ReadOnly)) {
-                qmlInfo(this) << "Can't open " << m_source << ": " << m_file.errorString();
-                m_status = Error;
+            m_fileData->map();
+            m_fileData->encoding = detectEncoding(&file, m_fileData->data, m_fileData->size);
+
+            if (m_fileData->size > maximumSynchronousSize) {
+                Reader *const reader = new Reader(m_fileData, m_startPosition);
+                reader->start();
+
+                m_status = Loading;
             } else {
-                m_textStream.setDevice(&m_file);
+                PlainTextIndex lines(m_fileData->encoding.unitSize);
+                qint64 position = m_fileData->encoding.byteOrderMarkSize;
+                bool continued = false;
 
-                if (m_file.size() > maximumSynchronousSize) {
-                    m_fileData = new FileData(this);
+                readLines(*m_fileData, &file, &position, m_fileData->size, &lines, &continued, maximumFileSize);
+                insertLines(std::move(lines), m_fileData->encoding.byteOrderMarkSize, position, false);
 
-                    Reader *const reader = new Reader(m_fileData);
-                    reader->start();
+                m_status = Ready;
+            }
+        }
+    }
 
-                    m_status = Loading;
-                } else {
-                    std::vector<Line> lines;
-                    std::vector<QString> text;
+    if (previousStatus != m_status) {
+        emit statusChanged();
+    }
+    if (previousEncoding != encoding()) {
+        emit encodingChanged();
+    }
+    if (previousCount != m_rowCount) {
+        emit countChanged();
+    }
+}
 
-                    readLines(&m_textStream, &lines, &text);
+void PlainTextModel::watch()
+{
+    delete m_watcher;
+    m_watcher = nullptr;
 
-                    if (!lines.empty()) {
-                        beginInsertRows(QModelIndex(), 0, lines.size() - 1);
+    if (m_follow && m_source.isLocalFile()) {
+        const QString fileName = m_source.toLocalFile();
 
-                        m_lines = std::move(lines);
+        m_watcher = new QFileSystemWatcher(this);
+        m_watcher->addPath(fileName);
+        // The directory is watched too, to notice when the file is replaced, e.g. when a log
+        // is rotated.
+        m_watcher->addPath(QFileInfo(fileName).absolutePath());
 
-                        int index = 0;
-                        for (const QString &lineText : text) {
-                            m_textCache.insert(index++, new QString(std::move(lineText)), lineText.length());
-                        }
+        connect(m_watcher, &QFileSystemWatcher::fileChanged, this, [this]() { update(); });
+        connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, [this]() { update(); });
+    }
+}
 
-                        endInsertRows();
-                    }
+void PlainTextModel::update()
+{
+    if (!m_fileData || !m_watcher || m_status == Loading) {
+        // Checked again once the reader is done.
+        return;
+    }
 
-                    m_status = Ready;
-                }
+    const QString fileName = m_fileData->fileName;
+    struct stat status;
+
+    if (::stat(QFile::encodeName(fileName).constData(), &status) != 0) {
+        // Keep what was read until a new file appears.
+        return;
+    } else if (status.st_ino != m_fileData->inode
+               || status.st_size < m_fileData->size
+               || status.st_size > maximumFileSize
+               || (!m_fileData->file.isOpen() && status.st_size > 0)) {
+        // The file was replaced or truncated, start over.
+        load();
+
+        m_watcher->removePath(fileName);
+        m_watcher->addPath(fileName);
+    } else if (status.st_size > m_fileData->size && m_fileData->searchers.load() == 0) {
+        // While a searcher reads the mapping, it is extended once the searcher is done.
+        readAppendedLines();
+    }
+}
+
+void PlainTextModel::readAppendedLines()
+{
+    FileData &fileData = *m_fileData;
+    const qint64 previousSize = fileData.size;
+
+    fileData.map();
+
+    // A last line without a line feed continues in the appended bytes.
+    qint64 position = m_indexEnd;
+    bool continued = false;
+    if (m_rowCount > 0) {
+        Segment &segment = m_segments.back();
+        const int row = segment.lines.count() - 1;
+        const qint64 offset = segment.lines.offset(row);
+
+        if (offset + segment.lines.length(row) == previousSize) {
+            continued = segment.lines.isContinuation(row);
+
+            beginRemoveRows(QModelIndex(), m_rowCount - 1, m_rowCount - 1);
+
+            m_textCache.remove(offset);
+            segment.lines.removeLast();
+            if (segment.lines.isEmpty()) {
+                m_segments.pop_back();
             }
-        }
+            --m_rowCount;
+            m_indexEnd = offset;
 
-        if (previousStatus != m_status) {
-            emit statusChanged();
-        }
-        if (previousCount != m_lines.size()) {
-            emit countChanged();
+            endRemoveRows();
+
+            position = offset;
         }
-        emit sourceChanged();
     }
+
+    const qint64 start = position;
+    PlainTextIndex lines(fileData.encoding.unitSize);
+    readLines(fileData, &fileData.file, &position, fileData.size, &lines, &continued, maximumFileSize);
+    insertLines(std::move(lines), start, position, false);
+
+    emit countChanged();
 }
 
 PlainTextModel::Status PlainTextModel::status() const
@@ -164,37 +543,234 @@ PlainTextModel::Status PlainTextModel::status() const
     return m_status;
 }
 
+QString PlainTextModel::encoding() const
+{
+    return m_fileData && m_fileData->encoding.codec
+            ? QString::fromLatin1(m_fileData->encoding.codec->name())
+            : QString();
+}
+
+bool PlainTextModel::searching() const
+{
+    return m_searching;
+}
+
+QObject *PlainTextModel::searchModel() const
+{
+    return m_searchModel;
+}
+
+void PlainTextModel::search(const QString &text)
+{
+    cancelSearch();
+
+    if (text.isEmpty() || !m_fileData) {
+        return;
+    }
+
+    m_searchText = text;
+    m_searchModel = new PlainTextSearchModel;
+    emit searchModelChanged();
+
+    m_searching = true;
+    emit searchingChanged();
+
+    // Matches are resolved to rows, so the search waits for the file to be indexed.
+    if (m_status != Loading) {
+        startSearch();
+    }
+}
+
+void PlainTextModel::cancelSearch(bool resetModel)
+{
+    if (m_fileData) {
+        m_fileData->searchId.ref();
+    }
+    if (resetModel && m_searchModel) {
+        delete m_searchModel;
+        m_searchModel = nullptr;
+        emit searchModelChanged();
+    }
+    if (m_searching) {
+        m_searching = false;
+        emit searchingChanged();
+    }
+}
+
+void PlainTextModel::startSearch()
+{
+    if (m_status != Ready || m_fileData->size <= m_fileData->encoding.byteOrderMarkSize) {
+        addSearchMatches(std::vector<qint64>(), 1, true);
+        return;
+    }
+
+    // Only ASCII compatible encodings are searched regardless of case.
+    const bool ignoreCase = m_fileData->encoding.unitSize == 1;
+
+    QTextCodec::ConverterState state(QTextCodec::IgnoreHeader);
+    QByteArray needle = m_fileData->encoding.codec->fromUnicode(
+                m_searchText.constData(), m_searchText.length(), &state);
+    if (ignoreCase) {
+        for (int i = 0; i < needle.size(); ++i) {
+            needle[i] = foldCase(needle.at(i));
+        }
+    }
+
+    Searcher * const searcher = new Searcher(m_fileData, needle, ignoreCase);
+    // Pick up what was appended while the mapping was in use.
+    connect(searcher, &QThread::finished, this, [this]() { update(); });
+    searcher->start();
+}
+
+void PlainTextModel::addSearchMatches(const std::vector<qint64> &offsets, float fraction, bool atEnd)
+{
+    if (!m_searchModel) {
+        return;
+    }
+
+    QVector<PlainTextSearchModel::Match> matches;
+    matches.reserve(int(offsets.size()));
+
+    for (const qint64 offset : offsets) {
+        const int index = rowAt(offset);
+        if (index < 0) {
+            continue;
+        }
+
+        // Only the beginning of the line up to the match is decoded, to find its column.
+        const Segment &segment = segmentAt(index);
+        const qint64 lineOffset = segment.lines.offset(index - segment.firstRow);
+        const Encoding &encoding = m_fileData->encoding;
+        int column = 0;
+        if (m_fileData->data) {
+            column = encoding.decode(m_fileData->data + lineOffset, offset - lineOffset).length();
+        } else if (m_fileData->file.seek(lineOffset)) {
+            const QByteArray bytes = m_fileData->file.read(offset - lineOffset);
+            column = encoding.decode(bytes.constData(), bytes.size()).length();
+        }
+
+        matches.append({ index, column, m_searchText.length() });
+    }
+
+    m_searchModel->addMatches(fraction, matches);
+
+    if (atEnd && m_searching) {
+        m_searching = false;
+        emit searchingChanged();
+    }
+}
+
+bool PlainTextModel::follow() const
+{
+    return m_follow;
+}
+
+void PlainTextModel::setFollow(bool follow)
+{
+    if (m_follow != follow) {
+        m_follow = follow;
+
+        if (m_follow && m_fileData && m_fileData->data) {
+            // Read the file again without mapping it.
+            load();
+        }
+        watch();
+        update();
+
+        emit followChanged();
+    }
+}
+
+qreal PlainTextModel::startPosition() const
+{
+    return m_startPosition;
+}
+
+void PlainTextModel::setStartPosition(qreal position)
+{
+    position = qBound<qreal>(0, position, 1);
+    if (m_startPosition != position) {
+        m_startPosition = position;
+        emit startPositionChanged();
+    }
+}
+
+int PlainTextModel::startRow() const
+{
+    return m_startRow;
+}
+
+int PlainTextModel::estimatedLineCount() const
+{
+    const qint64 indexed = m_indexEnd - m_indexStart;
+    if (m_status != Loading || indexed <= 0) {
+        return m_rowCount;
+    } else {
+        const qint64 size = m_fileData->size - m_fileData->encoding.byteOrderMarkSize;
+        return int(qMin<qint64>(INT_MAX, m_rowCount * size / indexed));
+    }
+}
+
+int PlainTextModel::estimatedFirstLine() const
+{
+    const qint64 indexed = m_indexEnd - m_indexStart;
+    if (indexed <= 0) {
+        return 0;
+    } else {
+        const qint64 skipped = m_indexStart - m_fileData->encoding.byteOrderMarkSize;
+        return int(qMin<qint64>(INT_MAX, m_rowCount * skipped / indexed));
+    }
+}
+
+qreal PlainTextModel::progress() const
+{
+    if (m_status != Loading) {
+        return m_status == Ready ? 1 : 0;
+    } else {
+        const qint64 size = m_fileData->size - m_fileData->encoding.byteOrderMarkSize;
+        return size > 0 ? qreal(m_indexEnd - m_indexStart) / size : 0;
+    }
+}
+
 QString PlainTextModel::textAt(int index) const
 {
-    QString * const line = const_cast<PlainTextModel *>(this)->lineAt(index);
-    return line ? *line : QString();
+    CachedLine * const line = const_cast<PlainTextModel *>(this)->lineAt(index);
+    return line ? line->text : QString();
+}
+
+size_t PlainTextModel::indexMemoryUsage() const
+{
+    size_t usage = m_segments.capacity() * sizeof(Segment);
+    for (const Segment &segment : m_segments)
+        usage += segment.lines.memoryUsage();
+    return usage;
 }
 
 QHash<int, QByteArray> PlainTextModel::roleNames() const
 {
     static const QHash<int, QByteArray> roleNames = {
-        { LineText, "lineText" }
+        { LineText, "lineText" },
+        { RichText, "richText" }
     };
     return roleNames;
 }
 
 QVariant PlainTextModel::data(const QModelIndex &index, int role) const
 {
-    if (QString * const line = role == LineText
-            ? static_cast<QString *>(index.internalPointer())
-            : nullptr) {
-        return *line;
-    } else if (index.isValid() && role == LineText) {
-        return QString();
-    } else {
+    // Lines are only decoded when a view asks for their text.
+    if (!index.isValid() || (role != LineText && role != RichText)) {
         return QVariant();
+    } else if (CachedLine * const line = const_cast<PlainTextModel *>(this)->lineAt(index.row())) {
+        return role == LineText ? QVariant(line->text) : QVariant(line->richText);
+    } else {
+        return role == LineText ? QVariant(QString()) : QVariant(false);
     }
 }
 
 QModelIndex PlainTextModel::index(int row, int column, const QModelIndex &parent) const
 {
-    return !parent.isValid() && row >=0 && row < int(m_lines.size()) && column == 0
-            ? createIndex(row, column, const_cast<PlainTextModel *>(this)->lineAt(row))
+    return !parent.isValid() && row >=0 && row < m_rowCount && column == 0
+            ? createIndex(row, column)
             : QModelIndex();
 }
 
@@ -205,7 +781,7 @@ QModelIndex PlainTextModel::parent(const QModelIndex &) const
 
 int PlainTextModel::rowCount(const QModelIndex &parent) const
 {
-    return !parent.isValid() ? m_lines.size() : 0;
+    return !parent.isValid() ? m_rowCount : 0;
 }
 
 int PlainTextModel::columnCount(const QModelIndex &parent) const
@@ -213,116 +789,694 @@ int PlainTextModel::columnCount(const QModelIndex &parent) const
     return !parent.isValid() ? 1 : 0;
 }
 
-QString *PlainTextModel::lineAt(int index)
+const PlainTextModel::Segment &PlainTextModel::segmentAt(int row) const
+{
+    const auto segment = std::upper_bound(
+                m_segments.begin(), m_segments.end(), row, [](int row, const Segment &segment) {
+        return row < segment.firstRow;
+    });
+    return *(segment - 1);
+}
+
+int PlainTextModel::rowAt(qint64 offset) const
+{
+    if (m_segments.empty() || offset < m_segments.front().lines.offset(0)) {
+        return -1;
+    }
+
+    const auto segment = std::upper_bound(
+                m_segments.begin(), m_segments.end(), offset, [](qint64 offset, const Segment &segment) {
+        return offset < segment.lines.offset(0);
+    }) - 1;
+
+    int first = 0;
+    int count = segment->lines.count();
+    while (count > 0) {
+        const int step = count / 2;
+        if (segment->lines.offset(first + step) <= offset) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    return segment->firstRow + first - 1;
+}
+
+void PlainTextModel::insertLines(PlainTextIndex &&lines, qint64 start, qint64 end, bool prepend)
 {
-    if (index < 0 || index >= int(m_lines.size())) {
+    const bool empty = m_indexStart == m_indexEnd;
+    if (empty || prepend) {
+        m_indexStart = start;
+    }
+    if (empty || !prepend) {
+        m_indexEnd = end;
+    }
+
+    if (lines.isEmpty()) {
+        return;
+    }
+
+    const int count = lines.count();
+    const int first = prepend ? 0 : m_rowCount;
+
+    beginInsertRows(QModelIndex(), first, first + count - 1);
+
+    if (prepend) {
+        for (Segment &segment : m_segments) {
+            segment.firstRow += count;
+        }
+        m_segments.insert(m_segments.begin(), Segment { 0, std::move(lines) });
+        m_startRow += count;
+    } else {
+        m_segments.push_back(Segment { m_rowCount, std::move(lines) });
+    }
+    m_rowCount += count;
+
+    endInsertRows();
+}
+
+PlainTextModel::CachedLine *PlainTextModel::lineAt(int index)
+{
+    if (index < 0 || index >= m_rowCount) {
         return nullptr;
-    } else if (QString * const text = m_textCache.object(index)) {
-        return text;
+    }
+
+    const Segment &segment = segmentAt(index);
+    const int row = index - segment.firstRow;
+    const qint64 offset = segment.lines.offset(row);
+
+    // Rows move when lines are prepended, so the text is cached by offset.
+    if (CachedLine * const cachedLine = m_textCache.object(offset)) {
+        return cachedLine;
     } else {
-        const Line &line = m_lines.at(index);
+        qint64 length = segment.lines.length(row);
+        const char *bytes = m_fileData->data ? m_fileData->data + offset : nullptr;
+        QByteArray buffer;
 
-        if (line.length == 0) {
+        if (length == 0) {
             return nullptr;
-        } else {
-            m_textStream.seek(line.offset);
+        } else if (!m_fileData->data) {
+            if (!m_fileData->file.seek(offset)) {
+                return nullptr;
+            }
+            buffer = m_fileData->file.read(length);
+            bytes = buffer.constData();
+            length = buffer.size();
+        }
+
+        QString lineText = m_fileData->encoding.decode(bytes, length);
+        if (lineText.endsWith(QLatin1Char('\r'))) {
+            lineText.chop(1);
+        }
+
+        // Markers are looked for in the raw bytes unless the encoding isn't ASCII compatible.
+        const bool richText = m_fileData->encoding.unitSize == 1
+                ? mayContainLinks(bytes, bytes + length)
+                : mayContainLinks(lineText.utf16(), lineText.utf16() + lineText.length());
 
-            QString * const text = new QString(Silica::Theme::_encodeTextLinks(m_textStream.readLine()));
-            m_textCache.insert(index, text, text->length());
+        CachedLine * const line = new CachedLine {
+            richText ? Silica::Theme::_encodeTextLinks(lineText) : lineText,
+            richText
+        };
+        m_textCache.insert(offset, line, line->text.length());
 
-            return text;
+        return line;
+    }
+}
+
+PlainTextModel::Encoding PlainTextModel::detectEncoding(QFile *file, const char *data, qint64 size)
+{
+    Encoding encoding;
+
+    QByteArray head = data ? QByteArray::fromRawData(data, int(qMin<qint64>(size, 4))) : file->peek(4);
+    encoding.codec = QTextCodec::codecForUtfText(head, nullptr);
+
+    if (!encoding.codec) {
+        // Without a byte order mark, samples from the start, the middle and the end of the
+        // file are checked for UTF-8. Files which aren't valid UTF-8 are read as Latin-1,
+        // unless the locale uses another 8 bit encoding.
+        bool utf8 = true;
+        for (qint64 sampleStart : { qint64(0), (size - sampleSize) / 2, size - sampleSize }) {
+            sampleStart = qMax<qint64>(0, sampleStart);
+            const qint64 sampleEnd = qMin(size, sampleStart + sampleSize);
+
+            QByteArray sample;
+            const char *bytes = data ? data + sampleStart : nullptr;
+            qint64 count = sampleEnd - sampleStart;
+            if (!bytes) {
+                file->seek(sampleStart);
+                sample = file->read(count);
+                bytes = sample.constData();
+                count = sample.size();
+            }
+
+            utf8 &= isUtf8(bytes, bytes + count, sampleStart == 0, sampleStart + count >= size);
         }
+        if (!data) {
+            file->seek(0);
+        }
+
+        QTextCodec * const locale = QTextCodec::codecForLocale();
+        if (utf8) {
+            encoding.codec = QTextCodec::codecForMib(106);
+            encoding.decoder = Encoding::Utf8Decoder;
+        } else if (locale->mibEnum() != 106) {
+            encoding.codec = locale;
+        } else {
+            encoding.codec = QTextCodec::codecForMib(4);
+            encoding.decoder = Encoding::Latin1Decoder;
+        }
+        return encoding;
+    }
+
+    switch (encoding.codec->mibEnum()) {
+    case 106:   // UTF-8
+        encoding.byteOrderMarkSize = 3;
+        encoding.decoder = Encoding::Utf8Decoder;
+        break;
+    case 1013:  // UTF-16BE
+        encoding.byteOrderMarkSize = 2;
+        encoding.unitSize = 2;
+        encoding.lineFeedByte = 1;
+        break;
+    case 1014:  // UTF-16LE
+        encoding.byteOrderMarkSize = 2;
+        encoding.unitSize = 2;
+        break;
+    case 1018:  // UTF-32BE
+        encoding.byteOrderMarkSize = 4;
+        encoding.unitSize = 4;
+        encoding.lineFeedByte = 3;
+        break;
+    case 1019:  // UTF-32LE
+        encoding.byteOrderMarkSize = 4;
+        encoding.unitSize = 4;
+        break;
+    default:
+        break;
+    }
+
+    return encoding;
+}
+
+QString PlainTextModel::Encoding::decode(const char *bytes, qint64 length) const
+{
+    switch (decoder) {
+    case Latin1Decoder:
+        return QString::fromLatin1(bytes, int(length));
+    case Utf8Decoder:
+        // Both conversions process runs of ASCII with SIMD instructions, but Latin-1 has
+        // no validation to do.
+        return isAscii(bytes, bytes + length)
+                ? QString::fromLatin1(bytes, int(length))
+                : QString::fromUtf8(bytes, int(length));
+    default:
+        return codec->toUnicode(bytes, int(length));
     }
 }
 
 bool PlainTextModel::readLines(
-        QTextStream *stream, std::vector<Line> *lines, std::vector<QString> *cache)
+        const FileData &fileData, QFile *file, qint64 *position, qint64 end,
+        PlainTextIndex *lines, bool *continued, qint64 maximumSize)
 {
-    const qint64 reserveSize = std::min(maximumCost, stream->device()->size()) / 80;
+    const qint64 readSize = qMin(blockSize, (maximumSize + 3) & ~qint64(3));
+    QByteArray buffer;
+    if (!fileData.data) {
+        buffer.resize(readSize);
+        file->seek(*position);
+    }
 
-    lines->reserve(reserveSize);
-    if (cache) {
-        cache->reserve(reserveSize);
+    const int firstLine = lines->count();
+    qint64 lineStart = *position;
+
+    // Always make some progress, even when a single line is longer than maximumSize.
+    for (qint64 blockStart = *position;
+         blockStart - *position < maximumSize || lines->count() == firstLine;) {
+        const char *block = buffer.constData();
+        qint64 count = qMin(readSize, end - blockStart);
+        if (count <= 0) {
+            count = 0;
+        } else if (fileData.data) {
+            block = fileData.data + blockStart;
+        } else {
+            count = file->read(buffer.data(), count);
+        }
+
+        if (count <= 0) {
+            if (blockStart > lineStart) {
+                lines->append(lineStart, blockStart - lineStart, *continued);
+                *continued = false;
+            }
+            *position = blockStart;
+            return true;
+        }
+
+        scanLines(fileData.encoding, block, count, blockStart, &lineStart, continued, lines, maximumRowLength);
+        blockStart += count;
+    }
+
+    // Resume from the beginning of the incomplete last row.
+    *position = lineStart;
+    return false;
+}
+
+void PlainTextModel::scanLines(
+        const Encoding &encoding, const char *block, qint64 count, qint64 blockStart,
+        qint64 *lineStart, bool *continued, PlainTextIndex *lines, qint64 maximumLength)
+{
+    // Lines are found by scanning the raw bytes for line feeds with memchr(), which
+    // is vectorized by the C library. Nothing is decoded until a line is displayed.
+    for (const char *lineFeed = block;
+         (lineFeed = static_cast<const char *>(std::memchr(lineFeed, '\n', block + count - lineFeed)));
+         ++lineFeed) {
+        const qint64 position = lineFeed - block;
+        const qint64 unitStart = position - position % encoding.unitSize;
+
+        if (encoding.unitSize > 1) {
+            // In UTF-16 and UTF-32 the byte must be the low byte of a 0x0a code unit.
+            if (position % encoding.unitSize != encoding.lineFeedByte
+                    || unitStart + encoding.unitSize > count) {
+                continue;
+            }
+            bool lineFeedUnit = true;
+            for (int i = 0; i < encoding.unitSize; ++i) {
+                lineFeedUnit &= unitStart + i == position || block[unitStart + i] == 0;
+            }
+            if (!lineFeedUnit) {
+                continue;
+            }
+        }
+
+        const qint64 offset = blockStart + unitStart;
+        splitLine(encoding, block, blockStart, offset, lineStart, continued, lines, maximumLength);
+        lines->append(*lineStart, offset - *lineStart, *continued);
+        *lineStart = offset + encoding.unitSize;
+        *continued = false;
     }
 
-    for (qint64 cost = 0; cost < maximumCost;) {
-        if (stream->atEnd()) {
+    // Rows are split as the block ends, because its bytes may not be available anymore
+    // when the line feed is found.
+    splitLine(encoding, block, blockStart, blockStart + count, lineStart, continued, lines, maximumLength);
+}
+
+void PlainTextModel::splitLine(
+        const Encoding &encoding, const char *block, qint64 blockStart, qint64 end,
+        qint64 *lineStart, bool *continued, PlainTextIndex *lines, qint64 maximumLength)
+{
+    const int unitSize = encoding.unitSize;
+
+    // Whether the code unit at position is a space or a tab.
+    const auto isBlank = [&](qint64 position) {
+        const uchar *unit = reinterpret_cast<const uchar *>(block + (position - blockStart));
+        bool blank = unit[encoding.lineFeedByte] == ' ' || unit[encoding.lineFeedByte] == '\t';
+        for (int i = 0; blank && i < unitSize; ++i) {
+            blank = i == encoding.lineFeedByte || unit[i] == 0;
+        }
+        return blank;
+    };
+    // Whether a character starts at position, i.e. it isn't a UTF-8 continuation byte or
+    // a UTF-16 low surrogate.
+    const auto isCharacterStart = [&](qint64 position) {
+        const uchar *unit = reinterpret_cast<const uchar *>(block + (position - blockStart));
+        switch (unitSize) {
+        case 1:
+            return encoding.decoder != Encoding::Utf8Decoder || (unit[0] & 0xc0) != 0x80;
+        case 2:
+            return unit[1 - encoding.lineFeedByte] < 0xdc || unit[1 - encoding.lineFeedByte] > 0xdf;
+        default:
             return true;
         }
+    };
 
-        const qint64 offset = stream->pos();
-        stream->seek(offset);   // This forces a flush or something to that effect. Without it each read-line gets progressively slower.
-        QString text = stream->readLine();
+    while (end - *lineStart > maximumLength) {
+        // Only the bytes of the current block can be looked at.
+        const qint64 limit = qMax(*lineStart + maximumLength, blockStart);
+        const qint64 first = qMax(qMax(*lineStart, blockStart), limit - splitSearchLength);
 
-        lines->push_back({ offset, text.length() });
-        if (cache) {
-            cache->push_back(Silica::Theme::_encodeTextLinks(text));
+        // Prefer splitting after a blank, to keep words and links in a single row.
+        qint64 split = limit;
+        while (split > first && !isBlank(split - unitSize)) {
+            split -= unitSize;
+        }
+        if (split == first) {
+            split = limit;
+            while (split + unitSize <= end && !isCharacterStart(split)) {
+                split += unitSize;
+            }
+        }
+        if (split + unitSize > end) {
+            // Try again with the following bytes.
+            return;
         }
 
-        cost += text.length();
+        lines->append(*lineStart, split - *lineStart, *continued);
+        *lineStart = split;
+        *continued = true;
     }
-    return false;
 }
 
-PlainTextModel::Reader::Reader(const QExplicitlySharedDataPointer<PlainTextModel::FileData> &fileData)
+qint64 PlainTextModel::findPreviousLineStart(const FileData &fileData, qint64 position)
+{
+    const Encoding &encoding = fileData.encoding;
+    const char * const begin = fileData.data + encoding.byteOrderMarkSize;
+    const char * const end = fileData.data + fileData.size;
+
+    for (const char *lineFeed = fileData.data + position;
+         (lineFeed = static_cast<const char *>(memrchr(begin, '\n', lineFeed - begin)));) {
+        const qint64 unitStart = (lineFeed - begin) - (lineFeed - begin) % encoding.unitSize;
+
+        bool lineFeedUnit = (lineFeed - begin) % encoding.unitSize == encoding.lineFeedByte
+                && begin + unitStart + encoding.unitSize <= end;
+        for (int i = 0; lineFeedUnit && i < encoding.unitSize; ++i) {
+            lineFeedUnit = begin + unitStart + i == lineFeed || begin[unitStart + i] == 0;
+        }
+        if (lineFeedUnit) {
+            return encoding.byteOrderMarkSize + unitStart + encoding.unitSize;
+        }
+    }
+    return encoding.byteOrderMarkSize;
+}
+
+qint64 PlainTextModel::findLineStart(const FileData &fileData, qint64 position)
+{
+    const Encoding &encoding = fileData.encoding;
+    position -= (position - encoding.byteOrderMarkSize) % encoding.unitSize;
+
+    // Any line start will do, so the whole block containing the first line feed is scanned.
+    PlainTextIndex lines(encoding.unitSize);
+    qint64 lineStart = position;
+    bool continued = false;
+    for (qint64 blockStart = position; blockStart < fileData.size && lines.isEmpty(); blockStart += blockSize) {
+        scanLines(encoding, fileData.data + blockStart, qMin(blockSize, fileData.size - blockStart),
+                  blockStart, &lineStart, &continued, &lines, std::numeric_limits<qint64>::max());
+    }
+    return !lines.isEmpty() ? lineStart : fileData.size;
+}
+
+void PlainTextModel::FileData::map()
+{
+    if (data) {
+        file.unmap(reinterpret_cast<uchar *>(const_cast<char *>(data)));
+        data = nullptr;
+    }
+
+    size = file.size();
+    if (followed) {
+        return;
+    }
+    data = reinterpret_cast<const char *>(file.map(0, size));
+    if (!data) {
+        // Fall back to reading the file, e.g. when it doesn't fit in the address space.
+        qWarning() << "Can't map" << fileName << ":" << file.errorString();
+    }
+}
+
+PlainTextModel::Reader::Reader(
+        const QExplicitlySharedDataPointer<PlainTextModel::FileData> &fileData,
+        qreal startPosition)
     : m_fileData(fileData)
+    , m_startPosition(startPosition)
 {
     connect(this, &QThread::finished, this, &QObject::deleteLater);
 }
 
 void PlainTextModel::Reader::run()
 {
-    QFile file(m_fileData->fileName);
+    const qint64 size = m_fileData->size;
+    const qint64 byteOrderMarkSize = m_fileData->encoding.byteOrderMarkSize;
 
-    if (!file.open(QIODevice::ReadOnly)) {
-        ReaderEvent * const event = new ReaderEvent(m_fileData);
-        event->atEnd = true;
-        QCoreApplication::postEvent(this, event);
-    } else {
-        QTextStream stream(&file);
+    if (!m_fileData->data) {
+        // The file is only read here when it couldn't be mapped, sequentially from the start.
+        QFile file(m_fileData->fileName);
+        const bool opened = file.open(QIODevice::ReadOnly);
 
-        bool atEnd = false;
-        for (bool cache = true; m_fileData->model && !atEnd; cache = false) {
+        qint64 position = byteOrderMarkSize;
+        bool continued = false;
+        bool atEnd = !opened;
+        qint64 chunkSize = maximumCost;
+        do {
             ReaderEvent * const event = new ReaderEvent(m_fileData);
 
-            atEnd = PlainTextModel::readLines(&stream, &event->lines, cache ? &event->text : nullptr);
+            event->start = position;
+            if (opened) {
+                atEnd = PlainTextModel::readLines(
+                            *m_fileData, &file, &position, size, &event->lines, &continued, chunkSize);
+            }
+            event->end = position;
             event->atEnd = atEnd;
 
             QCoreApplication::postEvent(this, event);
+
+            chunkSize = maximumChunkSize;
+        } while (m_fileData->model && !atEnd);
+
+        return;
+    }
+
+    // Indexing starts from the line containing the start position and extends in both
+    // directions, so the lines there can be shown before the rest of the file is indexed.
+    const qint64 anchor = m_startPosition > 0
+            ? findPreviousLineStart(*m_fileData, byteOrderMarkSize + qint64((size - byteOrderMarkSize) * m_startPosition))
+            : byteOrderMarkSize;
+
+    qint64 start = anchor;
+    qint64 end = anchor;
+
+    // Publish a first screen of lines on each side of the anchor as soon as possible.
+    ReaderEvent * const event = new ReaderEvent(m_fileData);
+    event->start = anchor;
+    // The first screen may end in the middle of a long line.
+    bool continued = false;
+    PlainTextModel::readLines(*m_fileData, nullptr, &end, size, &event->lines, &continued, maximumCost);
+    event->end = end;
+
+    ReaderEvent *previousEvent = nullptr;
+    if (start > byteOrderMarkSize) {
+        previousEvent = new ReaderEvent(m_fileData);
+        start = start - maximumCost > byteOrderMarkSize
+                ? findPreviousLineStart(*m_fileData, start - maximumCost)
+                : byteOrderMarkSize;
+
+        qint64 position = start;
+        bool previousContinued = false;
+        PlainTextModel::readLines(
+                    *m_fileData, nullptr, &position, anchor, &previousEvent->lines, &previousContinued,
+                    anchor - start);
+        previousEvent->start = start;
+        previousEvent->end = anchor;
+        previousEvent->prepend = true;
+    }
+
+    const bool atEnd = start == byteOrderMarkSize && end == size;
+    event->atEnd = atEnd && !previousEvent;
+    QCoreApplication::postEvent(this, event);
+    if (previousEvent) {
+        previousEvent->atEnd = atEnd;
+        QCoreApplication::postEvent(this, previousEvent);
+    }
+
+    if (atEnd) {
+        return;
+    }
+
+    // Index the rest of the file in chunks ending on line boundaries on all cores, and
+    // publish them in order outward from the anchor as they complete.
+    QThreadPool pool;
+    pool.setMaxThreadCount(QThread::idealThreadCount());
+
+    QQueue<Indexer *> nextIndexers;
+    QQueue<Indexer *> previousIndexers;
+    while ((end < size || start > byteOrderMarkSize) && m_fileData->model) {
+        if (end < size) {
+            const qint64 next = end + maximumChunkSize < size
+                    ? findLineStart(*m_fileData, end + maximumChunkSize)
+                    : size;
+
+            nextIndexers.enqueue(new Indexer(m_fileData, end, next, continued));
+            pool.start(nextIndexers.last());
+            continued = false;
+
+            end = next;
         }
+        if (start > byteOrderMarkSize) {
+            const qint64 previous = start - maximumChunkSize > byteOrderMarkSize
+                    ? findPreviousLineStart(*m_fileData, start - maximumChunkSize)
+                    : byteOrderMarkSize;
+
+            previousIndexers.enqueue(new Indexer(m_fileData, previous, start));
+            pool.start(previousIndexers.last());
+
+            start = previous;
+        }
+    }
+
+    while (!nextIndexers.isEmpty() || !previousIndexers.isEmpty()) {
+        if (!nextIndexers.isEmpty()) {
+            Indexer * const indexer = nextIndexers.dequeue();
+            publish(indexer, false, nextIndexers.isEmpty() && previousIndexers.isEmpty());
+        }
+        if (!previousIndexers.isEmpty()) {
+            Indexer * const indexer = previousIndexers.dequeue();
+            publish(indexer, true, nextIndexers.isEmpty() && previousIndexers.isEmpty());
+        }
+
+        if (!m_fileData->model) {
+            pool.clear();
+            pool.waitForDone();
+            qDeleteAll(nextIndexers);
+            qDeleteAll(previousIndexers);
+            break;
+        }
+    }
+}
+
+void PlainTextModel::Reader::publish(Indexer *indexer, bool prepend, bool atEnd)
+{
+    indexer->m_done.acquire();
+
+    if (m_fileData->model) {
+        ReaderEvent * const event = new ReaderEvent(m_fileData);
+        event->lines = std::move(indexer->m_lines);
+        event->start = indexer->m_start;
+        event->end = indexer->m_end;
+        event->prepend = prepend;
+        event->atEnd = atEnd;
+
+        QCoreApplication::postEvent(this, event);
     }
+
+    delete indexer;
 }
 
 PlainTextModel::ReaderEvent::ReaderEvent(
         const QExplicitlySharedDataPointer<PlainTextModel::FileData> &fileData)
     : QEvent(QEvent::None)
     , fileData(fileData)
+    , lines(fileData->encoding.unitSize)
 {
 }
 
 PlainTextModel::ReaderEvent::~ReaderEvent()
 {
-    if (fileData->model) {
-        if (!lines.empty()) {
-            size_t first = fileData->model->m_lines.size();
-            size_t last = first + lines.size() - 1;
+    if (PlainTextModel * const model = fileData->model) {
+        model->insertLines(std::move(lines), start, end, prepend);
 
-            fileData->model->beginInsertRows(QModelIndex(), first, last);
+        if (atEnd) {
+            model->m_status = Ready;
+        }
 
-            fileData->model->m_lines.reserve(last);
-            fileData->model->m_lines.insert(fileData->model->m_lines.end(), lines.begin(), lines.end());
+        emit model->countChanged();
 
-            for (const QString &lineText : text) {
-                fileData->model->m_textCache.insert(first++, new QString(std::move(lineText)), lineText.length());
-            }
+        if (atEnd) {
+            emit model->statusChanged();
 
-            fileData->model->endInsertRows();
-            emit fileData->model->countChanged();
+            // Pick up whatever was appended while the file was indexed.
+            model->update();
+
+            if (model->m_searching) {
+                model->startSearch();
+            }
         }
+    }
+}
 
-        if (atEnd) {
-            fileData->model->m_status = Ready;
-            emit fileData->model->statusChanged();
+PlainTextModel::Indexer::Indexer(
+        const QExplicitlySharedDataPointer<PlainTextModel::FileData> &fileData,
+        qint64 start, qint64 end, bool continued)
+    : m_fileData(fileData)
+    , m_lines(fileData->encoding.unitSize)
+    , m_start(start)
+    , m_end(end)
+    , m_continued(continued)
+{
+    setAutoDelete(false);
+}
+
+void PlainTextModel::Indexer::run()
+{
+    if (m_fileData->model) {
+        qint64 position = m_start;
+        bool continued = m_continued;
+        // Allow one more byte than the chunk so the scan reaches m_end and flushes the row
+        // in progress there. It is only non empty for a file that doesn't end with a line feed.
+        PlainTextModel::readLines(
+                    *m_fileData, nullptr, &position, m_end, &m_lines, &continued, m_end - m_start + 1);
+    }
+    m_done.release();
+}
+
+PlainTextModel::Searcher::Searcher(
+        const QExplicitlySharedDataPointer<PlainTextModel::FileData> &fileData,
+        const QByteArray &needle, bool ignoreCase)
+    : m_fileData(fileData)
+    , m_needle(needle)
+    , m_searchId(fileData->searchId.load())
+    , m_ignoreCase(ignoreCase)
+{
+    m_fileData->searchers.ref();
+    connect(this, &QThread::finished, this, &QObject::deleteLater);
+}
+
+void PlainTextModel::Searcher::run()
+{
+    search();
+    m_fileData->searchers.deref();
+}
+
+void PlainTextModel::Searcher::search()
+{
+    // The file is only read here when it couldn't be mapped.
+    QFile file(m_fileData->fileName);
+    if (!m_fileData->data && !file.open(QIODevice::ReadOnly)) {
+        SearchEvent * const event = new SearchEvent(m_fileData, m_searchId);
+        event->atEnd = true;
+        QCoreApplication::postEvent(this, event);
+        return;
+    }
+
+    const Encoding &encoding = m_fileData->encoding;
+    const qint64 size = m_fileData->size;
+    QByteArray buffer;
+
+    for (qint64 position = encoding.byteOrderMarkSize;
+         position < size && m_fileData->searchId.load() == m_searchId;) {
+        // Chunks overlap so matches across their boundaries are found.
+        const qint64 limit = qMin(size, position + maximumChunkSize);
+        const qint64 end = qMin(size, limit + m_needle.size() - 1);
+
+        const char *bytes = m_fileData->data ? m_fileData->data + position : nullptr;
+        qint64 count = end - position;
+        if (!bytes) {
+            file.seek(position);
+            buffer = file.read(count);
+            bytes = buffer.constData();
+            count = buffer.size();
         }
+
+        SearchEvent * const event = new SearchEvent(m_fileData, m_searchId);
+        findMatches(m_needle, m_ignoreCase, encoding.unitSize, encoding.byteOrderMarkSize,
+                    bytes, count, position, limit, &event->offsets);
+
+        position = count > 0 ? limit : size;
+        event->fraction = float(position - encoding.byteOrderMarkSize) / (size - encoding.byteOrderMarkSize);
+        event->atEnd = position >= size;
+
+        QCoreApplication::postEvent(this, event);
+    }
+}
+
+PlainTextModel::SearchEvent::SearchEvent(
+        const QExplicitlySharedDataPointer<PlainTextModel::FileData> &fileData, int searchId)
+    : QEvent(QEvent::None)
+    , fileData(fileData)
+    , searchId(searchId)
+{
+}
+
+PlainTextModel::SearchEvent::~SearchEvent()
+{
+    if (fileData->model && fileData->searchId.load() == searchId) {
+        fileData->model->addSearchMatches(offsets, fraction, atEnd);
     }
 }
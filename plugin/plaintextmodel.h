@@ -22,26 +22,43 @@
 #include <QAbstractItemModel>
 #include <QCache>
 #include <QExplicitlySharedDataPointer>
-#include <QFile>
-#include <QTextStream>
 #include <QUrl>
 
+#include "plaintextindex.h"
+
 #include <vector>
 
+class QFile;
+class QFileSystemWatcher;
+class PlainTextSearchModel;
+class QTextCodec;
+
 class PlainTextModel : public QAbstractItemModel
 {
     Q_OBJECT
     Q_PROPERTY(QUrl source READ source WRITE setSource NOTIFY sourceChanged)
     Q_PROPERTY(Status status READ status NOTIFY statusChanged)
+    Q_PROPERTY(QString encoding READ encoding NOTIFY encodingChanged)
     Q_PROPERTY(int lineCount READ rowCount NOTIFY countChanged)
+    Q_PROPERTY(qreal startPosition READ startPosition WRITE setStartPosition NOTIFY startPositionChanged)
+    Q_PROPERTY(int startRow READ startRow NOTIFY countChanged)
+    Q_PROPERTY(int estimatedLineCount READ estimatedLineCount NOTIFY countChanged)
+    Q_PROPERTY(int estimatedFirstLine READ estimatedFirstLine NOTIFY countChanged)
+    Q_PROPERTY(qreal progress READ progress NOTIFY countChanged)
+    Q_PROPERTY(bool follow READ follow WRITE setFollow NOTIFY followChanged)
+    Q_PROPERTY(bool searching READ searching NOTIFY searchingChanged)
+    Q_PROPERTY(QObject* searchModel READ searchModel NOTIFY searchModelChanged)
     Q_DISABLE_COPY(PlainTextModel)
 public:
     static constexpr qint64 maximumFileSize = INT_MAX; // This is probably a little optimistic.
     static constexpr qint64 maximumSynchronousSize = 4000;
     static constexpr qint64 maximumCost = 16000;
+    static constexpr qint64 maximumChunkSize = 4 * 1024 * 1024;
+    static constexpr qint64 maximumRowLength = 1024; // Longer lines are split into several rows.
 
     enum Roles {
-        LineText
+        LineText,
+        RichText
     };
 
     enum Status {
@@ -59,9 +76,31 @@ public:
     void setSource(const QUrl &source);
 
     Status status() const;
+    QString encoding() const;
+
+    qreal startPosition() const;
+    void setStartPosition(qreal position);
+
+    int startRow() const;
+    int estimatedLineCount() const;
+    int estimatedFirstLine() const;
+    qreal progress() const;
+
+    bool follow() const;
+    void setFollow(bool follow);
+
+    bool searching() const;
+    QObject *searchModel() const;
+
+    // Searches the file for text, ignoring the case of ASCII letters, once it is indexed.
+    Q_INVOKABLE void search(const QString &text);
+    Q_INVOKABLE void cancelSearch(bool resetModel = true);
 
     Q_INVOKABLE QString textAt(int index) const;
 
+    // Approximate size of the line index in bytes.
+    size_t indexMemoryUsage() const;
+
     QHash<int, QByteArray> roleNames() const override;
 
     QVariant data(const QModelIndex &index, int role) const override;
@@ -73,36 +112,98 @@ public:
 signals:
     void sourceChanged();
     void statusChanged();
+    void encodingChanged();
     void countChanged();
+    void startPositionChanged();
+    void followChanged();
+    void searchingChanged();
+    void searchModelChanged();
 
 private:
     struct FileData;
     class Reader;
     class ReaderEvent;
+    class Indexer;
+    class Searcher;
+    class SearchEvent;
 
     friend struct FileData;
     friend class Reader;
     friend class ReaderEvent;
+    friend class Indexer;
+    friend class Searcher;
+    friend class SearchEvent;
 
-    struct Line
+    // How line feeds are laid out in the file.
+    struct Encoding
     {
-        Line() = default;
-        Line(qint64 offset, qint64 length) : offset(offset), length(length) {}
-        qint64 offset = 0;
-        qint64 length = 0;
+        enum Decoder {
+            CodecDecoder,
+            Latin1Decoder,
+            Utf8Decoder
+        };
+
+        inline QString decode(const char *bytes, qint64 length) const;
+
+        QTextCodec *codec = nullptr;
+        Decoder decoder = CodecDecoder;
+        qint64 byteOrderMarkSize = 0;
+        int unitSize = 1;       // Size of a code unit, 2 for UTF-16, 4 for UTF-32.
+        int lineFeedByte = 0;   // Position of the 0x0a byte in a line feed code unit.
     };
 
-    inline QString *lineAt(int index);
-    inline static bool readLines(
-            QTextStream *stream, std::vector<Line> *lines, std::vector<QString> *cache);
+    // Consecutive lines indexed together, the first one being at firstRow in the model.
+    struct Segment
+    {
+        int firstRow;
+        PlainTextIndex lines;
+    };
 
-    std::vector<Line> m_lines;
-    QCache<int, QString> m_textCache { maximumCost + (maximumCost / 20) };
+    inline void load();
+    inline void watch();
+    inline void update();
+    inline void readAppendedLines();
+    inline void startSearch();
+    inline void addSearchMatches(const std::vector<qint64> &offsets, float fraction, bool atEnd);
+    inline const Segment &segmentAt(int row) const;
+    inline int rowAt(qint64 offset) const;
+    inline void insertLines(PlainTextIndex &&lines, qint64 start, qint64 end, bool prepend);
+    // The text of a line, with links encoded as markup when richText is set.
+    struct CachedLine
+    {
+        QString text;
+        bool richText;
+    };
+
+    inline CachedLine *lineAt(int index);
+    inline static Encoding detectEncoding(QFile *file, const char *data, qint64 size);
+    inline static bool readLines(
+            const FileData &fileData, QFile *file, qint64 *position, qint64 end,
+            PlainTextIndex *lines, bool *continued, qint64 maximumSize);
+    inline static void scanLines(
+            const Encoding &encoding, const char *block, qint64 count, qint64 blockStart,
+            qint64 *lineStart, bool *continued, PlainTextIndex *lines, qint64 maximumLength);
+    inline static void splitLine(
+            const Encoding &encoding, const char *block, qint64 blockStart, qint64 end,
+            qint64 *lineStart, bool *continued, PlainTextIndex *lines, qint64 maximumLength);
+    inline static qint64 findLineStart(const FileData &fileData, qint64 position);
+    inline static qint64 findPreviousLineStart(const FileData &fileData, qint64 position);
+
+    // The indexed lines cover the bytes from m_indexStart to m_indexEnd.
+    std::vector<Segment> m_segments;
+    int m_rowCount = 0;
+    int m_startRow = 0;
+    qint64 m_indexStart = 0;
+    qint64 m_indexEnd = 0;
+    qreal m_startPosition = 0;
+    bool m_follow = false;
+    QString m_searchText;
+    PlainTextSearchModel *m_searchModel = nullptr;
+    bool m_searching = false;
+    QCache<qint64, CachedLine> m_textCache { maximumCost + (maximumCost / 20) };
     QExplicitlySharedDataPointer<FileData> m_fileData;
-    QFile m_file;
-    QTextStream m_textStream;
+    QFileSystemWatcher *m_watcher = nullptr;
     QUrl m_source;
-    qint64 m_cost =  0;
     Status m_status = Null;
 };
 
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026 Caliste Damien.
+ * Contact: Damien Caliste <dcaliste@free.fr>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 only.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "plaintextsearchmodel.h"
+
+class PlainTextSearchModel::Private
+{
+public:
+    Private()
+      : m_fraction(0.f)
+    {
+        roles.insert(Row, "row");
+        roles.insert(Column, "column");
+        roles.insert(Length, "length");
+    }
+    QVector<Match> m_matches;
+    QHash<int, QByteArray> roles;
+    float m_fraction;
+};
+
+PlainTextSearchModel::PlainTextSearchModel(QObject *parent)
+  : QAbstractListModel(parent), d(new Private)
+{
+}
+
+PlainTextSearchModel::~PlainTextSearchModel()
+{
+}
+
+QHash<int, QByteArray> PlainTextSearchModel::roleNames() const
+{
+    return d->roles;
+}
+
+QVariant PlainTextSearchModel::data(const QModelIndex& index, int role) const
+{
+    QVariant result;
+    if (index.isValid()) {
+        int row = index.row();
+        if (row > -1 && row < d->m_matches.count()) {
+            const Match &match = d->m_matches.at(row);
+            switch(role)
+            {
+            case Row:
+                result.setValue<int>(match.row);
+                break;
+            case Column:
+                result.setValue<int>(match.column);
+                break;
+            case Length:
+                result.setValue<int>(match.length);
+                break;
+            default:
+                result.setValue<QString>(QString("Unknown role: %1").arg(role));
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+int PlainTextSearchModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return d->m_matches.count();
+}
+
+int PlainTextSearchModel::count() const
+{
+    return d->m_matches.count();
+}
+
+float PlainTextSearchModel::fraction() const
+{
+    return d->m_fraction;
+}
+
+void PlainTextSearchModel::addMatches(float fraction, const QVector<Match> &matches)
+{
+    if (!matches.isEmpty()) {
+        beginInsertRows(QModelIndex(), d->m_matches.count(),
+                        d->m_matches.count() + matches.count() - 1);
+        d->m_matches += matches;
+        endInsertRows();
+        emit countChanged();
+    }
+
+    d->m_fraction = fraction;
+    emit fractionChanged();
+}
+
+int PlainTextSearchModel::rowAt(int index) const
+{
+    return index >= 0 && index < d->m_matches.count() ? d->m_matches.at(index).row : -1;
+}
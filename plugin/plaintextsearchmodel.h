@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2026 Caliste Damien.
+ * Contact: Damien Caliste <dcaliste@free.fr>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 only.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PLAINTEXTSEARCHMODEL_H
+#define PLAINTEXTSEARCHMODEL_H
+
+#include <QtCore/QAbstractListModel>
+#include <QtCore/QVector>
+
+class PlainTextSearchModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(float fraction READ fraction NOTIFY fractionChanged)
+
+public:
+    enum PlainTextSearchModelRoles {
+        Row = Qt::UserRole + 1,
+        Column,
+        Length
+    };
+
+    // A match, with its column and length in characters.
+    struct Match
+    {
+        int row;
+        int column;
+        int length;
+    };
+
+    explicit PlainTextSearchModel(QObject *parent = 0);
+    virtual ~PlainTextSearchModel();
+
+    virtual QVariant data(const QModelIndex &index, int role) const;
+    virtual int rowCount(const QModelIndex &parent) const;
+    virtual QHash<int, QByteArray> roleNames() const;
+
+    int count() const;
+    float fraction() const;
+    void addMatches(float fraction, const QVector<Match> &matches);
+
+    Q_INVOKABLE int rowAt(int index) const;
+
+Q_SIGNALS:
+    void countChanged();
+    void fractionChanged();
+
+private:
+    class Private;
+    const QScopedPointer<Private> d;
+};
+
+#endif // PLAINTEXTSEARCHMODEL_H
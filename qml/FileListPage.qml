@@ -62,7 +62,7 @@ Page {
 
     FilterModel {
         id: filteredModel
-        filterRegExp: RegExp(searchText, "i")
+        filterText: searchText
     }
 
     SilicaListView {
@@ -163,7 +163,7 @@ Page {
         delegate: ListItem {
             id: listItem
 
-            contentHeight: Theme.itemSizeMedium
+            contentHeight: Math.max(Theme.itemSizeMedium, column.height + 2 * Theme.paddingSmall)
             hidden: deletingSource === model.filePath
 
             Image {
@@ -174,8 +174,22 @@ Page {
                     verticalCenter: parent.verticalCenter
                 }
                 source: window.mimeToIcon(model.fileMimeType) + (highlighted ? "?" + Theme.highlightColor : "")
+                visible: thumbnail.status !== Image.Ready
+            }
+            Image {
+                id: thumbnail
+                anchors.centerIn: icon
+                width: Theme.iconSizeMedium
+                height: Theme.iconSizeMedium
+                sourceSize { width: Theme.iconSizeMedium; height: Theme.iconSizeMedium }
+                fillMode: Image.PreserveAspectFit
+                // Rendered on a thread, the icon is shown until then.
+                source: model.fileMimeType === "application/pdf" || model.fileMimeType === "text/plain"
+                        ? "image://thumbnail/" + encodeURIComponent(model.filePath) : ""
+                visible: status === Image.Ready
             }
             Column {
+                id: column
                 anchors {
                     left: icon.right
                     leftMargin: Theme.paddingMedium
@@ -193,6 +207,16 @@ Page {
                     font.pixelSize: Theme.fontSizeMedium
                     truncationMode: TruncationMode.Fade
                 }
+                Label {
+                    // Listed for words found in its path or type rather than its name.
+                    width: parent.width
+                    visible: model.matchedPath.length > 0
+                    color: listItem.highlighted ? Theme.secondaryHighlightColor : Theme.secondaryColor
+                    text: visible ? Theme.highlightText(model.matchedPath, searchText, Theme.highlightColor) : ""
+                    textFormat: Text.StyledText
+                    font.pixelSize: Theme.fontSizeExtraSmall
+                    truncationMode: TruncationMode.Fade
+                }
                 Item {
                     width: parent.width
                     height: sizeLabel.height
@@ -204,7 +228,7 @@ Page {
                     }
                     Label {
                         anchors.right: parent.right
-                        text: Format.formatDate(model.fileRead, Format.Timepoint)
+                        text: Format.formatDate(new Date(model.fileReadTime), Format.Timepoint)
                         font.pixelSize: Theme.fontSizeExtraSmall
                         color: listItem.highlighted ? Theme.secondaryHighlightColor : Theme.secondaryColor
                     }
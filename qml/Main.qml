@@ -53,13 +53,34 @@ ApplicationWindow {
 
     FileInfo {
         id: fileInfo
+
+        property bool _opening
+
+        onReadyChanged: {
+            if (ready && _opening) {
+                _opening = false
+                window._openDocument()
+            }
+        }
     }
 
     function openFile(file) {
+        fileInfo._opening = false
         fileInfo.source = file
 
         pageStack.pop(window._mainPage, PageStackAction.Immediate)
 
+        // The mime type is only known once the file has been looked up. Nothing is
+        // looked up without a source, there is nothing to wait for then.
+        fileInfo._opening = fileInfo.source !== "" && !fileInfo.ready
+        if (fileInfo.ready) {
+            _openDocument()
+        }
+
+        activate()
+    }
+
+    function _openDocument() {
         var handler = ""
 
         switch (fileInfo.mimeType) {
@@ -110,8 +131,6 @@ ApplicationWindow {
                            { title: fileInfo.fileName, source: fileInfo.fullPath, mimeType: fileInfo.mimeType },
                            PageStackAction.Immediate)
         }
-
-        activate()
     }
 
     function mimeToIcon(fileMimeType) {